@@ -0,0 +1,338 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\BuddyAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+#include "../DataStructures/DoublyLinkedList.h"
+
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Binary buddy allocator
+// The memory is a binary tree of power of 2 blocks, the smallest is MinBlockSize.
+// Each level has a free list, stored inside the free blocks, and the tree state is stored in 2 bitmaps at the beginning of the area:
+// - split bitmap: one bit per internal node, set when the node is split in its 2 children, used on Free to find the level of the block
+// - buddy bitmap: one bit per internal node, it is "free(left) XOR free(right)", used on Free to know if the buddy can be merged
+// The tree is the smallest power of 2 covering the area after the bitmaps, the blocks past the end of the area are never given back.
+template<size MinBlockSize>
+class BuddyAllocator
+{
+private:
+	static_assert(CoreUtils::IsPowerOf2(MinBlockSize), "MinBlockSize must be power of 2");
+
+	struct FreeHeader {};
+	using Node = typename DoublyLinkedList<FreeHeader>::Node;
+
+	static_assert(MinBlockSize >= sizeof(Node), "MinBlockSize must be able to store a free list node");
+
+	static constexpr uint32 kMaxLevels = 48;
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	BuddyAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_levelCount(0), m_usedMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		// find the smallest tree covering the area left after the bitmaps
+		const uintPtr first = CoreUtils::AlignTop(m_start, MinBlockSize);
+		eosAssertReturnVoid(first + MinBlockSize < m_end, "Area is too small for this allocator");
+
+		uint32 levelCount = 1;
+		while (levelCount < kMaxLevels)
+		{
+			const uintPtr base = CoreUtils::AlignTop(first + GetBitmapSize(levelCount) * 2, MinBlockSize);
+			if (base >= m_end || (m_end - base) <= (MinBlockSize << (levelCount - 1)))
+			{
+				break;
+			}
+			++levelCount;
+		}
+
+		m_levelCount = levelCount;
+		m_splitBitmap = (uint8*)first;
+		m_buddyBitmap = (uint8*)first + GetBitmapSize(m_levelCount);
+		m_base = CoreUtils::AlignTop(first + GetBitmapSize(m_levelCount) * 2, MinBlockSize);
+		m_last = m_base + ((m_end - m_base) & ~(MinBlockSize - 1));
+
+		eosAssertReturnVoid(m_base < m_last, "Area is too small for this allocator");
+
+		Reset();
+	}
+
+	~BuddyAllocator()
+	{
+
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+		eosAssertReturnValue(_alignment <= MinBlockSize, nullptr, "Alignment must be less or equal than the minimum block size");
+
+		// every block is aligned to MinBlockSize, so the padding does not depend by the block found
+		const size padding = GetPadding(_alignment, _headerSize);
+		const uint32 order = GetOrder(_size + padding);
+
+		if (order >= m_levelCount)
+		{
+			eosAssert(false, "Requested size is too big for this allocator");
+			return nullptr;
+		}
+
+		const uint32 level = m_levelCount - 1 - order;
+
+		// look for the closest level with a free block, going up to the bigger blocks
+		uint32 freeLevel = level;
+		while (freeLevel > 0 && m_freeLists[freeLevel].GetHead() == nullptr)
+		{
+			--freeLevel;
+		}
+
+		Node* block = m_freeLists[freeLevel].GetHead();
+
+		if (block == nullptr)
+		{
+			eosAssert(false, "Memory over, please resize the allocator!");
+			return nullptr;
+		}
+
+		m_freeLists[freeLevel].Remove(block);
+
+		size index = GetNodeIndex((uintPtr)block, freeLevel);
+		if (freeLevel > 0)
+		{
+			FlipBit(m_buddyBitmap, GetParentIndex(index));
+		}
+
+		// split down to the level requested, giving the right half back each time
+		while (freeLevel < level)
+		{
+			SetBit(m_splitBitmap, index);
+			FlipBit(m_buddyBitmap, index);
+
+			++freeLevel;
+			index = GetLeftChildIndex(index);
+
+			Node* buddy = (Node*)((uintPtr)block + GetBlockSize(freeLevel));
+			m_freeLists[freeLevel].Push(buddy);
+		}
+
+		m_usedMemory += GetBlockSize(level);
+
+		return (void*)((uintPtr)block + padding);
+	}
+
+	EOS_INLINE void Free(void* _ptr, size /*_size*/)
+	{
+		uint32 level = 0;
+		size index = 0;
+		const uintPtr blockAddress = FindBlock((uintPtr)_ptr, level, index);
+
+		ReleaseBlock(blockAddress, level, index);
+	}
+
+	// the level comes from the size as in Allocate, so the split bitmap is not walked
+	EOS_INLINE void FreeSized(void* _ptr, size _size, size _alignment, size _headerSize)
+	{
+		const uint32 level = m_levelCount - 1 - GetOrder(_size + GetPadding(_alignment, _headerSize));
+		const uintPtr blockAddress = m_base + (((uintPtr)_ptr - m_base) & ~(GetBlockSize(level) - 1));
+
+#ifdef _DEBUG
+		uint32 foundLevel = 0;
+		size foundIndex = 0;
+		eosAssertReturnVoid(FindBlock((uintPtr)_ptr, foundLevel, foundIndex) == blockAddress && foundLevel == level, "The size or the alignment given to Free are not the ones of the allocation");
+#endif
+
+		ReleaseBlock(blockAddress, level, GetNodeIndex(blockAddress, level));
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		uint32 level = 0;
+		size index = 0;
+		const uintPtr blockAddress = FindBlock((uintPtr)_ptr, level, index);
+
+		// remove the padding, because outside is expecting the allocated plain memory
+		return GetBlockSize(level) - ((uintPtr)_ptr - blockAddress);
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_usedMemory = 0;
+
+		const size bitmapSize = GetBitmapSize(m_levelCount);
+		for (size i = 0; i < bitmapSize; ++i)
+		{
+			m_splitBitmap[i] = 0;
+			m_buddyBitmap[i] = 0;
+		}
+
+		for (uint32 i = 0; i < kMaxLevels; ++i)
+		{
+			m_freeLists[i].SetHead(nullptr);
+		}
+
+		// the tree can be bigger than the area, the part outside is left as used forever
+		uint32 level = 0;
+		size index = 0;
+		uintPtr address = m_base;
+		while (address + GetBlockSize(level) > m_last)
+		{
+			SetBit(m_splitBitmap, index);
+
+			++level;
+			index = GetLeftChildIndex(index);
+
+			const uintPtr right = address + GetBlockSize(level);
+			if (right < m_last)
+			{
+				// left child is fully inside, so free, and the right child has to be split again
+				FlipBit(m_buddyBitmap, GetParentIndex(index));
+				m_freeLists[level].Push((Node*)address);
+
+				address = right;
+				++index;
+			}
+		}
+
+		if (level > 0)
+		{
+			FlipBit(m_buddyBitmap, GetParentIndex(index));
+		}
+		m_freeLists[level].Push((Node*)address);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemory;
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+private:
+	// one bit for each internal node of the tree
+	static EOS_INLINE size GetBitmapSize(uint32 _levelCount)
+	{
+		const size internalNodeCount = (static_cast<size>(1) << (_levelCount - 1));
+		return (internalNodeCount + 7) / 8;
+	}
+
+	static EOS_INLINE size GetParentIndex(size _index) { return (_index - 1) / 2; }
+	static EOS_INLINE size GetLeftChildIndex(size _index) { return _index * 2 + 1; }
+
+	static EOS_INLINE bool GetBit(const uint8* _bitmap, size _index) { return (_bitmap[_index >> 3] & (1 << (_index & 7))) != 0; }
+	static EOS_INLINE void SetBit(uint8* _bitmap, size _index) { _bitmap[_index >> 3] |= static_cast<uint8>(1 << (_index & 7)); }
+	static EOS_INLINE void ClearBit(uint8* _bitmap, size _index) { _bitmap[_index >> 3] &= static_cast<uint8>(~(1 << (_index & 7))); }
+	static EOS_INLINE void FlipBit(uint8* _bitmap, size _index) { _bitmap[_index >> 3] ^= static_cast<uint8>(1 << (_index & 7)); }
+
+	EOS_INLINE size GetBlockSize(uint32 _level) const
+	{
+		return MinBlockSize << (m_levelCount - 1 - _level);
+	}
+
+	EOS_INLINE size GetNodeIndex(uintPtr _address, uint32 _level) const
+	{
+		return (static_cast<size>(1) << _level) - 1 + (_address - m_base) / GetBlockSize(_level);
+	}
+
+	static EOS_INLINE size GetPadding(size _alignment, size _headerSize)
+	{
+		return CoreUtils::AlignTop(_headerSize, _alignment) - _headerSize;
+	}
+
+	// the blocks of the order are 2^order times MinBlockSize
+	static EOS_INLINE uint32 GetOrder(size _size)
+	{
+		const size blockCount = (_size + MinBlockSize - 1) / MinBlockSize;
+		return blockCount <= 1 ? 0 : CoreUtils::FindLastSet64(static_cast<uint64>(blockCount - 1)) + 1;
+	}
+
+	// merge with the buddy as long as it is free as well
+	EOS_INLINE void ReleaseBlock(uintPtr _blockAddress, uint32 _level, size _index)
+	{
+		m_usedMemory -= GetBlockSize(_level);
+
+		uint32 level = _level;
+		size index = _index;
+		uintPtr address = _blockAddress;
+		while (level > 0)
+		{
+			const size parent = GetParentIndex(index);
+			FlipBit(m_buddyBitmap, parent);
+			if (GetBit(m_buddyBitmap, parent))
+			{
+				break;
+			}
+
+			const uintPtr buddyAddress = m_base + ((address - m_base) ^ GetBlockSize(level));
+			m_freeLists[level].Remove((Node*)buddyAddress);
+
+			ClearBit(m_splitBitmap, parent);
+
+			address = address < buddyAddress ? address : buddyAddress;
+			index = parent;
+			--level;
+		}
+
+		m_freeLists[level].Push((Node*)address);
+	}
+
+	// walk the tree from the root following the split nodes, the block is the first not split node
+	EOS_INLINE uintPtr FindBlock(uintPtr _ptr, uint32& _level, size& _index) const
+	{
+		const uintPtr offset = (_ptr - m_base) & ~(MinBlockSize - 1);
+
+		uint32 level = 0;
+		size index = 0;
+		while (level < m_levelCount - 1 && GetBit(m_splitBitmap, index))
+		{
+			++level;
+			index = GetLeftChildIndex(index) + ((offset & GetBlockSize(level)) != 0 ? 1 : 0);
+		}
+
+		_level = level;
+		_index = index;
+		return m_base + (offset & ~(GetBlockSize(level) - 1));
+	}
+
+private:
+	DoublyLinkedList<FreeHeader> m_freeLists[kMaxLevels];
+
+	uint8* m_splitBitmap;
+	uint8* m_buddyBitmap;
+
+	uintPtr m_start;
+	uintPtr m_end;
+	uintPtr m_base;
+	uintPtr m_last;
+
+	uint32 m_levelCount;
+
+	size m_usedMemory;
+};
+
+
+template<size MinBlockSize>
+using BuddyAllocationPolicy = AllocationPolicy<BuddyAllocator<MinBlockSize>, AllocationHeader>;
+
+EOS_NAMESPACE_END
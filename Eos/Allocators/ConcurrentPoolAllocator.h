@@ -0,0 +1,177 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\ConcurrentPoolAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <atomic>
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Lock free version of the PoolAllocator
+// The free list is a Treiber stack of chunk indices: the head is a 64 bit word with the index of the top chunk in the low 32 bits
+// and a version tag in the high 32 bits, incremented at every change, so a pop cannot succeed on a head changed in the meantime (ABA).
+// The index of the next free chunk is stored at the beginning of the free chunk.
+// Allocate and Free can be called from many threads at once, so the MemoryAllocator can use the SingleThreadPolicy,
+// as long as the other policies used are thread safe as well. Reset is not thread safe.
+template<size ChunkSize, size Alignment>
+class ConcurrentPoolAllocator
+{
+private:
+	static constexpr uint32 kInvalidIndex = ~0u;
+
+	static_assert(std::atomic<uint64>::is_always_lock_free, "ConcurrentPoolAllocator requires a lock free 64 bit atomic");
+
+public:
+	// is a pool allocator, array makes no sense, it is allocated already at construction time the full list and you get one by one
+	static constexpr bool kAllowedAllocationArray = false;
+
+	ConcurrentPoolAllocator(void* _start, void* _end, size _headerSize, size _footerSize) : m_usedMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		m_fullChunkSize = (ChunkSize + _headerSize + _footerSize);
+
+		// every chunk has to keep the memory after the header aligned, and has to be able to store the next index when free
+		const size minChunkSize = m_fullChunkSize > sizeof(uint32) ? m_fullChunkSize : sizeof(uint32);
+		m_chunkStride = CoreUtils::AlignTop(minChunkSize, Alignment > sizeof(uint32) ? Alignment : sizeof(uint32));
+		m_first = CoreUtils::AlignTop(m_start + _headerSize, Alignment > sizeof(uint32) ? Alignment : sizeof(uint32)) - _headerSize;
+
+		Reset();
+	}
+
+	~ConcurrentPoolAllocator()
+	{
+
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size /*_headerSize*/, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_size == m_fullChunkSize, nullptr, "Allocation size must be equal to chunk size");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(_alignment == Alignment, nullptr, "Alignment must be equal to alignment set");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+		(void)_size;
+		(void)_alignment;
+
+		uint64 head = m_head.load(std::memory_order_acquire);
+		while (true)
+		{
+			const uint32 index = GetIndex(head);
+
+			if (index == kInvalidIndex)
+			{
+				eosAssert(false, "The allocator is full");
+				return nullptr;
+			}
+
+			// the chunk can be popped by another thread meanwhile, in that case the next read is garbage but the tag makes the exchange fail
+			const uint32 next = GetNext(index).load(std::memory_order_relaxed);
+			const uint64 newHead = MakeHead(GetTag(head) + 1, next);
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+			{
+				m_usedMemory.fetch_add(m_fullChunkSize, std::memory_order_relaxed);
+				return (void*)GetChunk(index);
+			}
+		}
+	}
+
+	EOS_INLINE void Free(void* _ptr, size /*_size*/)
+	{
+		const uint32 index = static_cast<uint32>(((uintPtr)_ptr - m_first) / m_chunkStride);
+
+		uint64 head = m_head.load(std::memory_order_relaxed);
+		while (true)
+		{
+			GetNext(index).store(GetIndex(head), std::memory_order_relaxed);
+			const uint64 newHead = MakeHead(GetTag(head) + 1, index);
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+
+		m_usedMemory.fetch_sub(m_fullChunkSize, std::memory_order_relaxed);
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return m_fullChunkSize;
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_usedMemory.store(0, std::memory_order_relaxed);
+
+		const size chunkCount = m_first < m_end ? (m_end - m_first) / m_chunkStride : 0;
+		m_chunkCount = static_cast<uint32>(chunkCount < kInvalidIndex ? chunkCount : kInvalidIndex - 1);
+
+		for (uint32 i = 0; i < m_chunkCount; ++i)
+		{
+			GetNext(i).store(i + 1 < m_chunkCount ? i + 1 : kInvalidIndex, std::memory_order_relaxed);
+		}
+
+		m_head.store(MakeHead(0, m_chunkCount > 0 ? 0 : kInvalidIndex), std::memory_order_release);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemory.load(std::memory_order_relaxed);
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+private:
+	static EOS_INLINE uint32 GetIndex(uint64 _head) { return static_cast<uint32>(_head); }
+	static EOS_INLINE uint32 GetTag(uint64 _head) { return static_cast<uint32>(_head >> 32); }
+	static EOS_INLINE uint64 MakeHead(uint32 _tag, uint32 _index) { return (static_cast<uint64>(_tag) << 32) | _index; }
+
+	EOS_INLINE uintPtr GetChunk(uint32 _index) const
+	{
+		return m_first + static_cast<uintPtr>(_index) * m_chunkStride;
+	}
+
+	EOS_INLINE std::atomic<uint32>& GetNext(uint32 _index) const
+	{
+		return *reinterpret_cast<std::atomic<uint32>*>(GetChunk(_index));
+	}
+
+private:
+	// each on its own cache line, so a change of the head does not invalidate the counter, and neither the read only fields
+	alignas(64) std::atomic<uint64> m_head;
+	alignas(64) std::atomic<size> m_usedMemory;
+
+	alignas(64) uintPtr m_start;
+	uintPtr m_end;
+	uintPtr m_first;
+
+	uint32 m_chunkCount;
+
+	size m_fullChunkSize;
+	size m_chunkStride;
+};
+
+
+template<size ChunkSize, size Alignment>
+using ConcurrentPoolAllocationPolicy = AllocationPolicy<ConcurrentPoolAllocator<ChunkSize, Alignment>, AllocationHeader>;
+
+EOS_NAMESPACE_END
@@ -0,0 +1,204 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\DoubleEndedStackAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryAllocationPolicy.h"
+#include "../MemoryLogPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Two stacks in the same area: the bottom one grows up from the start, the top one grows down from the end.
+// Usually the bottom is for the persistent data and the top for the transient data.
+// The end is given to Allocate, GetMarker and RewindTo, without it they work on the bottom. The allocator does not keep
+// any end in use, so the threads can work on different ends at the same time with the MultiThreadPolicy.
+// The StackEndAllocator below is one end with the interface of an allocator, for the eosNew and the Scope.
+// The allocator is out of memory when the two ends meet.
+class DoubleEndedStackAllocator
+{
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	DoubleEndedStackAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+		m_bottom = m_start;
+		m_top = m_end;
+	}
+
+	~DoubleEndedStackAllocator()
+	{
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size _footerSize)
+	{
+		return Allocate(EStackEnd_Bottom, _size, _alignment, _headerSize, _footerSize);
+	}
+
+	EOS_INLINE void* Allocate(EStackEnd _end, size _size, size _alignment, size _headerSize, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+
+		uintPtr address = 0;
+		if (_end == EStackEnd_Bottom)
+		{
+			address = CoreUtils::AlignTop(m_bottom + _headerSize, _alignment) - _headerSize;
+			if (address > m_top || m_top - address < _size)
+			{
+				eosAssert(false, "Double Ended Stack Allocator is out of memory");
+				return nullptr;
+			}
+
+			m_bottom = address + _size;
+		}
+		else
+		{
+			// checked before subtracting, the top cannot go below the bottom, also in release
+			if (m_top - m_bottom < _size)
+			{
+				eosAssert(false, "Double Ended Stack Allocator is out of memory");
+				return nullptr;
+			}
+
+			address = CoreUtils::AlignBottom(m_top - _size + _headerSize, _alignment) - _headerSize;
+			if (address < m_bottom)
+			{
+				eosAssert(false, "Double Ended Stack Allocator is out of memory");
+				return nullptr;
+			}
+
+			m_top = address;
+		}
+
+		return (void*)address;
+	}
+
+	// Single allocation cannot be freed, rewind to a marker instead
+	EOS_INLINE void Free(void* /*_ptr*/, size /*_size*/)
+	{
+	}
+
+	// The double ended stack allocator never store its own size
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return 0;
+	}
+
+	EOS_INLINE uintPtr GetMarker() const
+	{
+		return GetMarker(EStackEnd_Bottom);
+	}
+
+	EOS_INLINE uintPtr GetMarker(EStackEnd _end) const
+	{
+		return _end == EStackEnd_Bottom ? m_bottom : m_top;
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		RewindTo(EStackEnd_Bottom, _marker);
+	}
+
+	EOS_INLINE void RewindTo(EStackEnd _end, uintPtr _marker)
+	{
+		if (_end == EStackEnd_Bottom)
+		{
+			eosAssertReturnVoid(_marker >= m_start && _marker <= m_bottom, "Marker is not valid for the bottom end");
+			m_bottom = _marker;
+		}
+		else
+		{
+			eosAssertReturnVoid(_marker >= m_top && _marker <= m_end, "Marker is not valid for the top end");
+			m_top = _marker;
+		}
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_bottom = m_start;
+		m_top = m_end;
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return (m_bottom - m_start) + (m_end - m_top);
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+
+private:
+	uintPtr m_start;
+	uintPtr m_end;
+	uintPtr m_bottom;
+	uintPtr m_top;
+};
+
+
+using DoubleEndedStackAllocationPolicy = AllocationPolicy<DoubleEndedStackAllocator, AllocationHeader>;
+
+
+// One end of a MemoryAllocator with more than one, for instance over the DoubleEndedStackAllocator.
+// It is only the allocator and the end, so there can be one for each end, also in different threads.
+template<class Allocator>
+class StackEndAllocator
+{
+public:
+	static constexpr bool kAllowedAllocationArray = Allocator::kAllowedAllocationArray;
+
+	StackEndAllocator(Allocator* _allocator, EStackEnd _end) : m_allocator(_allocator), m_end(_end)
+	{
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		return m_allocator->Allocate(m_end, _size, _alignment, _sourceInfo);
+	}
+
+	EOS_INLINE void Free(void* _ptr)
+	{
+		m_allocator->Free(_ptr);
+	}
+
+	EOS_INLINE void Free(void* _ptr, size _size, size _alignment)
+	{
+		m_allocator->Free(_ptr, _size, _alignment);
+	}
+
+	EOS_INLINE uintPtr GetMarker()
+	{
+		return m_allocator->GetMarker(m_end);
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		m_allocator->RewindTo(m_end, _marker);
+	}
+
+	EOS_INLINE EStackEnd GetEnd() const { return m_end; }
+
+private:
+	Allocator* m_allocator;
+	EStackEnd m_end;
+};
+
+EOS_NAMESPACE_END
\ No newline at end of file
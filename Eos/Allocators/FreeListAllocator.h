@@ -6,12 +6,13 @@
 
 
 #include <limits>
+#include <type_traits>
 
 #include "../Core/BasicTypes.h"
 #include "../Core/Assertions.h"
 #include "../Core/NumberUtils.h"
 #include "../Core/PointerUtils.h"
-#include "../DataStructures/LinkedList.h"
+#include "../DataStructures/DoublyLinkedList.h"
 
 #include "../MemoryAllocationPolicy.h"
 
@@ -21,34 +22,101 @@ EOS_NAMESPACE_BEGIN
 
 enum EFreeListSearch
 {
-	EFreeListSearch_First,
-	EFreeListSearch_Best
+	EFreeListSearch_First,		// the first free block big enough, the free list has the last freed blocks first
+	EFreeListSearch_Best,
+	EFreeListSearch_Indexed		// best fit, the free blocks are also in a tree ordered by size, so the search is O(log n)
 };
 
 
+// A block of the heap, as given by the heap walk
+struct FreeListHeapBlock
+{
+	void* m_block;		// nullptr to start the walk
+	void* m_data;		// the memory given by the allocation, nullptr for the free blocks
+	size m_blockSize;
+	size m_padding;		// for the alignment, between the tag and the memory given
+	bool m_isFree;
+};
+
+// The free blocks of the heap by size, taken by walking all the blocks
+struct FreeListFragmentationReport
+{
+	static constexpr uint32 kHistogramSize = 64;
+
+	size m_totalMemory;
+	size m_freeMemory;
+	size m_usedBlockCount;
+	size m_freeBlockCount;
+	size m_largestFreeBlock;
+	size m_paddingWaste;			// taken by the padding of the aligned allocations
+	double m_externalFragmentation;	// the part of the free memory not in the largest free block, from 0 to 1
+
+	size m_freeBlockHistogram[kHistogramSize];	// the free blocks with size from 2^i to 2^(i+1) - 1
+};
+
+
+// Every block starts with a tag, its size with 2 flags in the low bits: if it is free and if the block before it is free.
+// The free blocks end with a footer, their size, so a block being freed finds both its neighbours in constant time
+// and it is merged with them without walking the free list, which is not in address order.
+// The allocated blocks without padding give the memory just after the tag, so they have no other header.
+// The ones with the alignment padding have the offset from the block start just before the memory given, marked by the low bit
+// of the tag which is never set for an allocated block without padding. The tag of these blocks has the same bit set,
+// and the offset is also at the start of the padding, so a walk from the start of the heap finds the padding too.
 template<EFreeListSearch Search>
 class FreeListAllocator
 {
 private:
 	struct  Header
 	{
-		size m_blockSize;
+		size m_blockSize;	// the tag of the block
+	};
+
+	// the free blocks of the indexed search are also the nodes of a treap, ordered by size and then by address,
+	// with the priority taken from the address
+	struct IndexedHeader
+	{
+		size m_blockSize;	// the tag of the block
+		IndexedHeader* m_left;
+		IndexedHeader* m_right;
+		IndexedHeader* m_parent;
 	};
-	struct AllocationHeader 
+
+	struct AllocationHeader
 	{
-		size m_blockSize;
-		uint8 m_padding;
+		size m_offset;		// shifted, with kPaddedFlag in the low bits
 	};
 
-	using Node = typename LinkedList<Header>::Node;
+	using FreeHeader = typename std::conditional<Search == EFreeListSearch_Indexed, IndexedHeader, Header>::type;
+	using Node = typename DoublyLinkedList<FreeHeader>::Node;
+
+	static constexpr size kTagSize = sizeof(size);
+
+	// every block starts and ends aligned to it, so the low bits of the sizes are free for the flags
+	static constexpr size kBlockAlignment = alignof(Node);
+
+	static constexpr size kFreeFlag = 1;
+	static constexpr size kPrevFreeFlag = 2;
+	static constexpr size kTagFlags = kFreeFlag | kPrevFreeFlag;
+	static constexpr size kPaddedFlag = 4;
+	static constexpr size kTagBits = kTagFlags | kPaddedFlag;
+	static constexpr size kPaddedShift = 3;
 
-	const size kAllocationHeaderSize = sizeof(AllocationHeader);
+	// the node and the footer
+	static constexpr size kMinBlockSize = sizeof(Node) + sizeof(size);
+
+	static_assert(kBlockAlignment > kTagBits, "The block alignment must leave the bits for the flags");
 
 public:
 	static constexpr bool kAllowedAllocationArray = true;
 
+	// to continue from a snapshot of the area, see the MappedFileArea
+	struct State
+	{
+		void* m_freeListHead;
+		size m_usedMemory;
+	};
 
-	FreeListAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_usedMemory(0)
+	FreeListAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_indexRoot(nullptr), m_usedMemory(0)
 	{
 		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
 		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
@@ -57,9 +125,41 @@ public:
 		m_start = (uintPtr)_start;
 		m_end = (uintPtr)_end;
 
+		eosAssertReturnVoid(GetBlocksEnd() > GetBlocksStart() + kMinBlockSize, "Area is too small for this allocator");
+
 		Reset();
 	}
 
+	// the free blocks are in the area, so the memory is not touched when there is a state
+	FreeListAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/, const State* _state) : m_indexRoot(nullptr), m_usedMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		eosAssertReturnVoid(GetBlocksEnd() > GetBlocksStart() + kMinBlockSize, "Area is too small for this allocator");
+
+		if (_state == nullptr)
+		{
+			Reset();
+			return;
+		}
+
+		eosAssertReturnVoid(_state->m_freeListHead == nullptr || ((uintPtr)_state->m_freeListHead >= m_start && (uintPtr)_state->m_freeListHead < m_end), "State is not valid for this area");
+
+		m_freeList.SetHead((Node*)_state->m_freeListHead);
+		m_usedMemory = _state->m_usedMemory;
+
+		// the index is not part of the state, it is built again from the free list
+		for (Node* it = m_freeList.GetHead(); it != nullptr; it = it->m_next)
+		{
+			IndexInsert(it);
+		}
+	}
+
 	~FreeListAllocator()
 	{
 
@@ -72,83 +172,149 @@ public:
 		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
 
 		Node* nodeFound = nullptr;
-		Node* prevNode = nullptr;
 		size padding = 0;
-		Find(_size, _alignment, _headerSize, padding, prevNode, nodeFound);
+		Find(_size, _alignment, _headerSize, padding, nodeFound);
 
-		eosAssertReturnValue(nodeFound != nullptr, nullptr, "Memory over, please resize the allocator!");
+		if (nodeFound == nullptr)
+		{
+			eosAssert(false, "Memory over, please resize the allocator!");
+			return nullptr;
+		}
 
-		const size requiredSize = _size + padding;
+		IndexRemove(nodeFound);
+		m_freeList.Remove(nodeFound);
 
-		const size left = nodeFound->m_data.m_blockSize - requiredSize;
+		// the block goes from the tag to the end of the allocation, the rest is a new free block if it can be one
+		const uintPtr block = (uintPtr)nodeFound;
+		const size freeSize = GetTagSize(nodeFound->m_data.m_blockSize);
+		size blockSize = GetBlockSize(kTagSize + padding + _size);
 
-		if (left > 0)
+		if (freeSize - blockSize >= kMinBlockSize)
 		{
-			Node* newFreeNode = (Node*)((size)nodeFound + kAllocationHeaderSize + requiredSize);
-			newFreeNode->m_data.m_blockSize = left;
-			m_freeList.Insert(nodeFound, newFreeNode);
+			// the block after the new free one has already the previous free flag
+			AddFreeBlock(block + blockSize, freeSize - blockSize, 0);
+		}
+		else
+		{
+			blockSize = freeSize;
+			ClearPrevFree(block + blockSize);
 		}
-		m_freeList.Remove(prevNode, nodeFound);
 
-		const size headerAddress = (size)(nodeFound) + padding;
+		// the block before a free one is never free
+		GetTag(block) = blockSize;
 
-		const size dataAddress = headerAddress + kAllocationHeaderSize;
-		((FreeListAllocator::AllocationHeader *) headerAddress)->m_blockSize = requiredSize;
-		((FreeListAllocator::AllocationHeader *) headerAddress)->m_padding = static_cast<uint8>(padding);
+		const uintPtr dataAddress = block + kTagSize + padding;
+		if (padding > 0)
+		{
+			const size offset = ((dataAddress - block) << kPaddedShift) | kPaddedFlag;
+			GetAllocationHeader(dataAddress)->m_offset = offset;
+			GetAllocationHeader(block + kTagSize + sizeof(AllocationHeader))->m_offset = offset;
+			GetTag(block) |= kPaddedFlag;
+		}
 
-		m_usedMemory += requiredSize;
+		m_usedMemory += blockSize;
 
 		return (void*)dataAddress;
 	}
 
 	EOS_INLINE void Free(void* _ptr, size /*_size*/)
 	{
-		const size currentAddress = (size)_ptr;
-		const size headerAddress = currentAddress - sizeof(FreeListAllocator::AllocationHeader);
-		const FreeListAllocator::AllocationHeader* allocationHeader { (FreeListAllocator::AllocationHeader*) headerAddress };
+		const uintPtr block = GetBlock((uintPtr)_ptr);
+		const size blockSize = GetTagSize(GetTag(block));
 
-		Node* freeNode = (Node*)(headerAddress);
-		freeNode->m_data.m_blockSize = allocationHeader->m_blockSize + allocationHeader->m_padding;
-		freeNode->m_next = nullptr;
+		eosAssertReturnVoid((GetTag(block) & kFreeFlag) == 0, "The block is already free");
 
-		Node* it = m_freeList.GetHead();
-		Node* itPrev = nullptr;
-		while (it != nullptr)
+		m_usedMemory -= blockSize;
+
+		ReleaseBlock(block, blockSize);
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		const uintPtr block = GetBlock((uintPtr)_ptr);
+
+		// I have to remove the padding and the header here, because outside is expecting the allocated plain memory
+		return GetTagSize(GetTag(block)) - ((uintPtr)_ptr - block);
+	}
+
+	// Grows the block absorbing the free block just after it, when there is one big enough
+	EOS_INLINE bool TryExpandInPlace(void* _ptr, size /*_oldSize*/, size _newSize)
+	{
+		const uintPtr block = GetBlock((uintPtr)_ptr);
+		const uintPtr blockEnd = block + GetTagSize(GetTag(block));
+		const uintPtr requiredEnd = block + GetBlockSize((uintPtr)_ptr + _newSize - block);
+
+		if (requiredEnd <= blockEnd)
 		{
-			if (_ptr < it) 
-			{
-				m_freeList.Insert(itPrev, freeNode);
-				break;
-			}
-			itPrev = it;
-			it = it->m_next;
+			return true;
+		}
+
+		if (blockEnd >= GetBlocksEnd() || (GetTag(blockEnd) & kFreeFlag) == 0)
+		{
+			return false;
+		}
+
+		const uintPtr freeEnd = blockEnd + GetTagSize(GetTag(blockEnd));
+		if (freeEnd < requiredEnd)
+		{
+			return false;
 		}
 
-		m_usedMemory -= freeNode->m_data.m_blockSize;
+		// the new free block can overlap the absorbed one, so this is removed first
+		IndexRemove((Node*)blockEnd);
+		m_freeList.Remove((Node*)blockEnd);
 
-		Coalescence(itPrev, freeNode);
+		uintPtr newBlockEnd = freeEnd;
+		if (freeEnd - requiredEnd >= kMinBlockSize)
+		{
+			AddFreeBlock(requiredEnd, freeEnd - requiredEnd, 0);
+			newBlockEnd = requiredEnd;
+		}
+		else
+		{
+			ClearPrevFree(freeEnd);
+		}
+
+		GetTag(block) = (newBlockEnd - block) | (GetTag(block) & (kPrevFreeFlag | kPaddedFlag));
+		m_usedMemory += newBlockEnd - blockEnd;
+
+		return true;
 	}
 
-	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	// Gives the tail of the block back as a free block, when it can be one
+	EOS_INLINE bool ShrinkInPlace(void* _ptr, size /*_oldSize*/, size _newSize)
 	{
-		const size currentAddress = (size)_ptr;
-		const size headerAddress = currentAddress - sizeof(FreeListAllocator::AllocationHeader);
-		const FreeListAllocator::AllocationHeader* allocationHeader{ (FreeListAllocator::AllocationHeader*) headerAddress };
+		const uintPtr block = GetBlock((uintPtr)_ptr);
+		const uintPtr blockEnd = block + GetTagSize(GetTag(block));
+		const uintPtr requiredEnd = block + GetBlockSize((uintPtr)_ptr + _newSize - block);
+
+		if (blockEnd < requiredEnd + kMinBlockSize)
+		{
+			return true;
+		}
 
-		// I have to remove the padding here, because outside is expecting the allocated plain memory
-		const size blockSize = allocationHeader->m_blockSize - allocationHeader->m_padding;
+		GetTag(block) = (requiredEnd - block) | (GetTag(block) & (kPrevFreeFlag | kPaddedFlag));
+		m_usedMemory -= blockEnd - requiredEnd;
 
-		return blockSize;
+		GetTag(requiredEnd) = blockEnd - requiredEnd;
+		ReleaseBlock(requiredEnd, blockEnd - requiredEnd);
+
+		return true;
 	}
 
 	EOS_INLINE void Reset()
 	{
 		m_usedMemory = 0;
-		Node* firstNode = (Node*)m_start;
-		firstNode->m_data.m_blockSize = GetTotalMemory();
-		firstNode->m_next = nullptr;
 		m_freeList.SetHead(nullptr);
-		m_freeList.Push(firstNode);
+		m_indexRoot = nullptr;
+
+		AddFreeBlock(GetBlocksStart(), GetBlocksEnd() - GetBlocksStart(), 0);
+	}
+
+	EOS_INLINE void GetState(State& _state) const
+	{
+		_state.m_freeListHead = (void*)m_freeList.GetHead();
+		_state.m_usedMemory = m_usedMemory;
 	}
 
 	EOS_INLINE size GetUsedMemory()  const
@@ -161,29 +327,348 @@ public:
 		return m_end - m_start;
 	}
 
+	// Calls the visitor with each block of the heap, as a FreeListHeapBlock, in address order.
+	// The blocks are found by their tags, so nothing must be allocated or freed during the walk.
+	template<typename Visitor>
+	void WalkHeap(Visitor&& _visitor) const
+	{
+		FreeListHeapBlock block = {};
+		while (GetNextHeapBlock(block))
+		{
+			_visitor(static_cast<const FreeListHeapBlock&>(block));
+		}
+	}
+
+	// A walk of all the heap, so it takes time linear in the number of blocks, without allocating
+	void GetFragmentationReport(FreeListFragmentationReport& _report) const
+	{
+		_report = {};
+		_report.m_totalMemory = GetBlocksEnd() - GetBlocksStart();
+
+		FreeListHeapBlock block = {};
+		while (GetNextHeapBlock(block))
+		{
+			if (!block.m_isFree)
+			{
+				++_report.m_usedBlockCount;
+				_report.m_paddingWaste += block.m_padding;
+				continue;
+			}
+
+			++_report.m_freeBlockCount;
+			_report.m_freeMemory += block.m_blockSize;
+			++_report.m_freeBlockHistogram[CoreUtils::FindLastSet64(static_cast<uint64>(block.m_blockSize))];
+			if (block.m_blockSize > _report.m_largestFreeBlock)
+			{
+				_report.m_largestFreeBlock = block.m_blockSize;
+			}
+		}
+
+		_report.m_externalFragmentation = _report.m_freeMemory > 0 ? 1.0 - static_cast<double>(_report.m_largestFreeBlock) / static_cast<double>(_report.m_freeMemory) : 0.0;
+	}
+
 private:
-	void Coalescence(Node* _prev, Node* _block)
+	// Gives the block after _block, or the first one when _block.m_block is nullptr, false after the last one
+	bool GetNextHeapBlock(FreeListHeapBlock& _block) const
+	{
+		const uintPtr block = _block.m_block == nullptr ? GetBlocksStart() : (uintPtr)_block.m_block + _block.m_blockSize;
+		if (block >= GetBlocksEnd())
+		{
+			return false;
+		}
+
+		const size tag = GetTag(block);
+		const size blockSize = GetTagSize(tag);
+
+		// not only an assert, with a broken tag the walk would never end or would go outside the heap, also in release
+		if (blockSize < kMinBlockSize || blockSize > GetBlocksEnd() - block)
+		{
+			eosAssert(false, "The heap is corrupted");
+			return false;
+		}
+
+		_block.m_block = (void*)block;
+		_block.m_blockSize = blockSize;
+		_block.m_isFree = (tag & kFreeFlag) != 0;
+		_block.m_padding = (tag & kPaddedFlag) != 0 ? (GetAllocationHeader(block + kTagSize + sizeof(AllocationHeader))->m_offset >> kPaddedShift) - kTagSize : 0;
+		_block.m_data = _block.m_isFree ? nullptr : (void*)(block + kTagSize + _block.m_padding);
+
+		return true;
+	}
+
+	static EOS_INLINE size& GetTag(uintPtr _block)
+	{
+		return *reinterpret_cast<size*>(_block);
+	}
+
+	static EOS_INLINE size GetTagSize(size _tag)
+	{
+		return _tag & ~kTagBits;
+	}
+
+	static EOS_INLINE AllocationHeader* GetAllocationHeader(uintPtr _dataAddress)
+	{
+		return reinterpret_cast<AllocationHeader*>(_dataAddress - sizeof(AllocationHeader));
+	}
+
+	// without padding the word before the memory is the tag itself
+	static EOS_INLINE uintPtr GetBlock(uintPtr _dataAddress)
+	{
+		const size offset = GetAllocationHeader(_dataAddress)->m_offset;
+		return (offset & kPaddedFlag) != 0 ? _dataAddress - (offset >> kPaddedShift) : _dataAddress - kTagSize;
+	}
+
+	EOS_INLINE uintPtr GetBlocksStart() const
+	{
+		return CoreUtils::AlignTop(m_start, kBlockAlignment);
+	}
+
+	EOS_INLINE uintPtr GetBlocksEnd() const
+	{
+		return m_end & ~(kBlockAlignment - 1);
+	}
+
+	// an allocated block must be able to be a free block once it is freed
+	EOS_INLINE size GetBlockSize(size _size) const
+	{
+		size blockSize = CoreUtils::AlignTop(_size, kBlockAlignment);
+		if (blockSize < kMinBlockSize)
+		{
+			blockSize = kMinBlockSize;
+		}
+		return blockSize;
+	}
+
+	// a padding must have room for the allocation header and for its copy at the start of the padding,
+	// the same one or one not overlapping it
+	EOS_INLINE size GetPadding(Node* _node, size _alignment, size _headerSize) const
+	{
+		const uintPtr curr = (uintPtr)_node + kTagSize;
+		size padding = CoreUtils::AlignTop(curr + _headerSize, _alignment) - _headerSize - curr;
+		while (padding > 0 && padding != sizeof(AllocationHeader) && padding < 2 * sizeof(AllocationHeader))
+		{
+			padding += _alignment;
+		}
+		return padding;
+	}
+
+	EOS_INLINE void ClearPrevFree(uintPtr _block)
+	{
+		if (_block < GetBlocksEnd())
+		{
+			GetTag(_block) &= ~kPrevFreeFlag;
+		}
+	}
+
+	// writes the tag and the footer, puts the block in the free list and tells the next block
+	EOS_INLINE void AddFreeBlock(uintPtr _block, size _blockSize, size _prevFreeFlag)
+	{
+		GetTag(_block) = _blockSize | kFreeFlag | _prevFreeFlag;
+		GetTag(_block + _blockSize - sizeof(size)) = _blockSize;
+
+		const uintPtr next = _block + _blockSize;
+		if (next < GetBlocksEnd())
+		{
+			GetTag(next) |= kPrevFreeFlag;
+		}
+
+		Node* node = (Node*)_block;
+		m_freeList.Push(node);
+		IndexInsert(node);
+	}
+
+	// merges the block with the free blocks next to it, found by the tags, before adding it to the free list
+	void ReleaseBlock(uintPtr _block, size _blockSize)
 	{
-		if (_block->m_next != nullptr && (size)_block + _block->m_data.m_blockSize == (size)_block->m_next)
+		const uintPtr next = _block + _blockSize;
+		if (next < GetBlocksEnd() && (GetTag(next) & kFreeFlag) != 0)
 		{
-			_block->m_data.m_blockSize += _block->m_next->m_data.m_blockSize;
-			m_freeList.Remove(_block, _block->m_next);
+			IndexRemove((Node*)next);
+			m_freeList.Remove((Node*)next);
+			_blockSize += GetTagSize(GetTag(next));
 		}
 
-		if (_prev != nullptr && (size)_prev + _prev->m_data.m_blockSize == (size)_block)
+		if ((GetTag(_block) & kPrevFreeFlag) != 0)
 		{
-			_prev->m_data.m_blockSize += _block->m_data.m_blockSize;
-			m_freeList.Remove(_prev, _block);
+			const size prevSize = GetTag(_block - sizeof(size));
+			_block -= prevSize;
+			_blockSize += prevSize;
+			IndexRemove((Node*)_block);
+			m_freeList.Remove((Node*)_block);
 		}
+
+		AddFreeBlock(_block, _blockSize, 0);
 	}
 
-	void Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _prev, Node*& _found)
+	void Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _found)
 	{
 		// look at the specialization
 	}
-	
+
+	// the size index is used only by the indexed search, for the others these do nothing
+	EOS_INLINE void IndexInsert(Node* _node)
+	{
+		IndexInsert(_node, MemUtils::IntToType<Search == EFreeListSearch_Indexed>());
+	}
+
+	EOS_INLINE void IndexRemove(Node* _node)
+	{
+		IndexRemove(_node, MemUtils::IntToType<Search == EFreeListSearch_Indexed>());
+	}
+
+	EOS_INLINE void IndexInsert(Node*, MemUtils::IntToType<false>) {}
+	EOS_INLINE void IndexRemove(Node*, MemUtils::IntToType<false>) {}
+
+	void IndexInsert(Node* _node, MemUtils::IntToType<true>)
+	{
+		IndexedHeader* node = &_node->m_data;
+		node->m_left = nullptr;
+		node->m_right = nullptr;
+
+		IndexedHeader* parent = nullptr;
+		IndexedHeader* it = m_indexRoot;
+		while (it != nullptr)
+		{
+			parent = it;
+			it = IsIndexLess(node, it) ? it->m_left : it->m_right;
+		}
+
+		node->m_parent = parent;
+		if (parent == nullptr)
+		{
+			m_indexRoot = node;
+		}
+		else if (IsIndexLess(node, parent))
+		{
+			parent->m_left = node;
+		}
+		else
+		{
+			parent->m_right = node;
+		}
+
+		while (node->m_parent != nullptr && GetIndexPriority(node) > GetIndexPriority(node->m_parent))
+		{
+			RotateIndexUp(node);
+		}
+	}
+
+	void IndexRemove(Node* _node, MemUtils::IntToType<true>)
+	{
+		IndexedHeader* node = &_node->m_data;
+
+		// rotated down until it has one child at most
+		while (node->m_left != nullptr && node->m_right != nullptr)
+		{
+			RotateIndexUp(GetIndexPriority(node->m_left) > GetIndexPriority(node->m_right) ? node->m_left : node->m_right);
+		}
+
+		IndexedHeader* child = node->m_left != nullptr ? node->m_left : node->m_right;
+		if (child != nullptr)
+		{
+			child->m_parent = node->m_parent;
+		}
+		ReplaceIndexChild(node->m_parent, node, child);
+	}
+
+	// the smallest free block of at least the given size
+	IndexedHeader* IndexLowerBound(size _size) const
+	{
+		IndexedHeader* found = nullptr;
+		IndexedHeader* it = m_indexRoot;
+		while (it != nullptr)
+		{
+			if (GetTagSize(it->m_blockSize) >= _size)
+			{
+				found = it;
+				it = it->m_left;
+			}
+			else
+			{
+				it = it->m_right;
+			}
+		}
+		return found;
+	}
+
+	static IndexedHeader* IndexNext(IndexedHeader* _node)
+	{
+		if (_node->m_right != nullptr)
+		{
+			IndexedHeader* it = _node->m_right;
+			while (it->m_left != nullptr)
+			{
+				it = it->m_left;
+			}
+			return it;
+		}
+
+		while (_node->m_parent != nullptr && _node->m_parent->m_right == _node)
+		{
+			_node = _node->m_parent;
+		}
+		return _node->m_parent;
+	}
+
+	static EOS_INLINE bool IsIndexLess(const IndexedHeader* _a, const IndexedHeader* _b)
+	{
+		return GetTagSize(_a->m_blockSize) < GetTagSize(_b->m_blockSize) || (GetTagSize(_a->m_blockSize) == GetTagSize(_b->m_blockSize) && _a < _b);
+	}
+
+	static EOS_INLINE uint32 GetIndexPriority(const IndexedHeader* _node)
+	{
+		return static_cast<uint32>((static_cast<uint64>((uintPtr)_node) * 11400714819323198485ull) >> 32);
+	}
+
+	EOS_INLINE void ReplaceIndexChild(IndexedHeader* _parent, IndexedHeader* _oldChild, IndexedHeader* _newChild)
+	{
+		if (_parent == nullptr)
+		{
+			m_indexRoot = _newChild;
+		}
+		else if (_parent->m_left == _oldChild)
+		{
+			_parent->m_left = _newChild;
+		}
+		else
+		{
+			_parent->m_right = _newChild;
+		}
+	}
+
+	// the node takes the place of its parent
+	void RotateIndexUp(IndexedHeader* _node)
+	{
+		IndexedHeader* parent = _node->m_parent;
+		IndexedHeader* grandParent = parent->m_parent;
+
+		if (parent->m_left == _node)
+		{
+			parent->m_left = _node->m_right;
+			if (_node->m_right != nullptr)
+			{
+				_node->m_right->m_parent = parent;
+			}
+			_node->m_right = parent;
+		}
+		else
+		{
+			parent->m_right = _node->m_left;
+			if (_node->m_left != nullptr)
+			{
+				_node->m_left->m_parent = parent;
+			}
+			_node->m_left = parent;
+		}
+
+		parent->m_parent = _node;
+		_node->m_parent = grandParent;
+		ReplaceIndexChild(grandParent, parent, _node);
+	}
+
 private:
-	LinkedList<Header> m_freeList;
+	DoublyLinkedList<FreeHeader> m_freeList;
+	IndexedHeader* m_indexRoot;
 
 	uintPtr m_start;
 	uintPtr m_end;
@@ -192,34 +677,29 @@ private:
 };
 
 template <>
-void FreeListAllocator<EFreeListSearch::EFreeListSearch_First>::Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _prev, Node*& _found)
+inline void FreeListAllocator<EFreeListSearch::EFreeListSearch_First>::Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _found)
 {
 	Node* it = m_freeList.GetHead();
-	Node* itPrev = nullptr;
 
 	while (it != nullptr)
 	{
-		const uintPtr curr = (uintPtr)it + kAllocationHeaderSize;
-		const uintPtr temp = CoreUtils::AlignTop(curr + _headerSize, _alignment) - _headerSize;
-		_padding = (temp - curr);
+		_padding = GetPadding(it, _alignment, _headerSize);
 
-		const size requiredSpace = _size + _padding;
+		const size requiredSpace = kTagSize + _padding + _size;
 
-		if (it->m_data.m_blockSize >= requiredSpace) 
+		if (GetTagSize(it->m_data.m_blockSize) >= requiredSpace)
 		{
 			break;
 		}
 
-		itPrev = it;
 		it = it->m_next;
 	}
 
-	_prev = itPrev;
 	_found = it;
 }
 
 template <>
-void FreeListAllocator<EFreeListSearch::EFreeListSearch_Best>::Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _prev, Node*& _found)
+inline void FreeListAllocator<EFreeListSearch::EFreeListSearch_Best>::Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _found)
 {
 #ifdef max
 #undef max
@@ -227,26 +707,69 @@ void FreeListAllocator<EFreeListSearch::EFreeListSearch_Best>::Find(const size _
 	size smallestDiff = std::numeric_limits<size>::max();
 
 	Node* bestBlock = nullptr;
+	size bestPadding = 0;
 	Node* it = m_freeList.GetHead();
-	Node* itPrev = nullptr;
 
-	while (it != nullptr) 
+	while (it != nullptr)
 	{
-		const uintPtr curr = (uintPtr)it + kAllocationHeaderSize;
-		const uintPtr temp = CoreUtils::AlignTop(curr + _headerSize, _alignment) - _headerSize;
-		_padding = (temp - curr);
+		const size padding = GetPadding(it, _alignment, _headerSize);
+
+		const size requiredSpace = kTagSize + padding + _size;
 
-		const size requiredSpace = _size + _padding;
+		const size blockSize = GetTagSize(it->m_data.m_blockSize);
 
-		if (it->m_data.m_blockSize >= requiredSpace && ( (it->m_data.m_blockSize - requiredSpace) < smallestDiff))
+		if (blockSize >= requiredSpace && ( (blockSize - requiredSpace) < smallestDiff))
 		{
+			smallestDiff = blockSize - requiredSpace;
 			bestBlock = it;
+			bestPadding = padding;
 		}
-		itPrev = it;
 		it = it->m_next;
 	}
 
-	_prev = it;
+	_padding = bestPadding;
+	_found = bestBlock;
+}
+
+// Same fit of the best search: it starts from the smallest block big enough without the padding,
+// and it stops at the blocks bigger than the best one plus the biggest padding, since they cannot fit better.
+// The nodes are aligned to kBlockAlignment, so up to that alignment the padding is the same for all of them.
+template <>
+inline void FreeListAllocator<EFreeListSearch::EFreeListSearch_Indexed>::Find(const size _size, const size _alignment, size _headerSize, size& _padding, Node*& _found)
+{
+	const size minimumSpace = kTagSize + _size;
+
+	Node* bestBlock = nullptr;
+	size bestPadding = 0;
+	size smallestDiff = 0;
+
+	for (IndexedHeader* it = IndexLowerBound(minimumSpace); it != nullptr; it = IndexNext(it))
+	{
+		const size blockSize = GetTagSize(it->m_blockSize);
+
+		if (bestBlock != nullptr)
+		{
+			const size maxPadding = _alignment > kBlockAlignment ? _alignment + 2 * sizeof(AllocationHeader) - 1 : bestPadding;
+			if (smallestDiff == 0 || blockSize - minimumSpace >= smallestDiff + maxPadding)
+			{
+				break;
+			}
+		}
+
+		Node* node = reinterpret_cast<Node*>(it);
+		const size padding = GetPadding(node, _alignment, _headerSize);
+
+		const size requiredSpace = minimumSpace + padding;
+
+		if (blockSize >= requiredSpace && (bestBlock == nullptr || (blockSize - requiredSpace) < smallestDiff))
+		{
+			smallestDiff = blockSize - requiredSpace;
+			bestBlock = node;
+			bestPadding = padding;
+		}
+	}
+
+	_padding = bestPadding;
 	_found = bestBlock;
 }
 
@@ -254,5 +777,6 @@ void FreeListAllocator<EFreeListSearch::EFreeListSearch_Best>::Find(const size _
 
 using FreeListBestSearchAllocationPolicy = AllocationPolicy<FreeListAllocator<EFreeListSearch::EFreeListSearch_Best>, AllocationHeader>;
 using FreeListFirstSearchAllocationPolicy = AllocationPolicy<FreeListAllocator<EFreeListSearch::EFreeListSearch_First>, AllocationHeader>;
+using FreeListIndexedSearchAllocationPolicy = AllocationPolicy<FreeListAllocator<EFreeListSearch::EFreeListSearch_Indexed>, AllocationHeader>;
 
 EOS_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,196 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\GrowingLinearAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryAreaPolicy.h"
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Linear allocator which does not fail when the area is over, but chains a new chunk taken from the ChunkSource.
+// Every new chunk is GrowthFactor times the previous one, or bigger if the allocation does not fit.
+// Reset keeps only the biggest chunk and gives the others back, so after some frames the allocator settles on one chunk.
+// The area given at construction time is the first chunk, it is never given back to the ChunkSource
+// and it is not used anymore once Reset keeps a bigger chunk.
+template<class ChunkSource = HeapChunkSource, size GrowthFactor = 2>
+class GrowingLinearAllocator
+{
+private:
+	static_assert(GrowthFactor >= 1, "GrowthFactor must be at least 1");
+
+	// at the beginning of every chunk, the area included
+	struct ChunkHeader
+	{
+		ChunkHeader* m_prev;
+		size m_size;
+		bool m_owned;
+	};
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	GrowingLinearAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_chunk(nullptr), m_usedMemoryInPrevChunks(0), m_totalMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+		eosAssertReturnVoid((uintPtr)_end - (uintPtr)_start > sizeof(ChunkHeader), "Area is too small for this allocator");
+
+		ChunkHeader* chunk = (ChunkHeader*)_start;
+		chunk->m_prev = nullptr;
+		chunk->m_size = (uintPtr)_end - (uintPtr)_start;
+		chunk->m_owned = false;
+
+		m_totalMemory = chunk->m_size;
+
+		SetCurrentChunk(chunk);
+	}
+
+	~GrowingLinearAllocator()
+	{
+		ChunkHeader* chunk = m_chunk;
+		while (chunk != nullptr)
+		{
+			ChunkHeader* prev = chunk->m_prev;
+			ReleaseChunk(chunk);
+			chunk = prev;
+		}
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+
+		const uintPtr address = CoreUtils::AlignTop(m_current + _headerSize, _alignment) - _headerSize;
+		if (address + _size <= m_chunkEnd)
+		{
+			m_current = address + _size;
+			return (void*)address;
+		}
+
+		return AllocateFromNewChunk(_size, _alignment, _headerSize);
+	}
+
+	// Cannot free a linear allocator
+	EOS_INLINE void Free(void* /*_ptr*/, size /*_size*/)
+	{
+	}
+
+	// The growing linear allocator never store its own size
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return 0;
+	}
+
+	EOS_INLINE void Reset()
+	{
+		ChunkHeader* biggest = m_chunk;
+		for (ChunkHeader* chunk = m_chunk->m_prev; chunk != nullptr; chunk = chunk->m_prev)
+		{
+			if (chunk->m_size > biggest->m_size)
+			{
+				biggest = chunk;
+			}
+		}
+
+		ChunkHeader* chunk = m_chunk;
+		while (chunk != nullptr)
+		{
+			ChunkHeader* prev = chunk->m_prev;
+			if (chunk != biggest)
+			{
+				ReleaseChunk(chunk);
+			}
+			chunk = prev;
+		}
+
+		biggest->m_prev = nullptr;
+
+		m_totalMemory = biggest->m_size;
+		m_usedMemoryInPrevChunks = 0;
+
+		SetCurrentChunk(biggest);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemoryInPrevChunks + (m_current - (uintPtr)m_chunk - sizeof(ChunkHeader));
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_totalMemory;
+	}
+
+private:
+	EOS_INLINE void SetCurrentChunk(ChunkHeader* _chunk)
+	{
+		m_chunk = _chunk;
+		m_current = (uintPtr)_chunk + sizeof(ChunkHeader);
+		m_chunkEnd = (uintPtr)_chunk + _chunk->m_size;
+	}
+
+	EOS_INLINE void ReleaseChunk(ChunkHeader* _chunk)
+	{
+		if (_chunk->m_owned)
+		{
+			ChunkSource::FreeChunk(_chunk, _chunk->m_size);
+		}
+	}
+
+	// slow path, the current chunk is full
+	void* AllocateFromNewChunk(size _size, size _alignment, size _headerSize)
+	{
+		const size requiredSize = sizeof(ChunkHeader) + _headerSize + _alignment + _size;
+		const size grownSize = m_chunk->m_size * GrowthFactor;
+		const size chunkSize = grownSize > requiredSize ? grownSize : requiredSize;
+
+		ChunkHeader* chunk = (ChunkHeader*)ChunkSource::AllocateChunk(chunkSize);
+		if (chunk == nullptr)
+		{
+			eosAssert(false, "Growing Linear Allocator cannot allocate a new chunk");
+			return nullptr;
+		}
+
+		chunk->m_prev = m_chunk;
+		chunk->m_size = chunkSize;
+		chunk->m_owned = true;
+
+		m_usedMemoryInPrevChunks += m_current - (uintPtr)m_chunk - sizeof(ChunkHeader);
+		m_totalMemory += chunkSize;
+
+		SetCurrentChunk(chunk);
+
+		const uintPtr address = CoreUtils::AlignTop(m_current + _headerSize, _alignment) - _headerSize;
+		m_current = address + _size;
+
+		return (void*)address;
+	}
+
+private:
+	ChunkHeader* m_chunk;
+
+	uintPtr m_current;
+	uintPtr m_chunkEnd;
+
+	size m_usedMemoryInPrevChunks;
+	size m_totalMemory;
+};
+
+
+template<class ChunkSource = HeapChunkSource, size GrowthFactor = 2>
+using GrowingLinearAllocationPolicy = AllocationPolicy<GrowingLinearAllocator<ChunkSource, GrowthFactor>, AllocationHeader>;
+
+EOS_NAMESPACE_END
\ No newline at end of file
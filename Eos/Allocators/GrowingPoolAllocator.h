@@ -0,0 +1,303 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\GrowingPoolAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+#include "../DataStructures/StackLinkedList.h"
+
+#include "../MemoryAreaPolicy.h"
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Pool allocator which does not fail when the area is over, but adds a slab of ChunksPerSlab chunks taken from the ChunkSource.
+// The chunks of all the slabs are in the same free list, and each chunk keeps a pointer to its slab just before it, to count the free chunks of the slab.
+// When ReleaseThresholdPercentage is greater than 0 and the used memory drops below that percentage of the total memory,
+// the slabs with all the chunks free are given back to the ChunkSource.
+// The area given at construction time is the first slab and it is never given back.
+template<size ChunkSize, size Alignment, class ChunkSource = HeapChunkSource, uint32 ChunksPerSlab = 64, size ReleaseThresholdPercentage = 0>
+class GrowingPoolAllocator
+{
+private:
+	static_assert(ChunksPerSlab > 0, "ChunksPerSlab must be greater than 0");
+	static_assert(ReleaseThresholdPercentage < 100, "ReleaseThresholdPercentage must be in the range [0, 100[");
+
+	struct FreeHeader {};
+	using Node = typename StackLinkedList<FreeHeader>::Node;
+
+	// at the beginning of every slab, the area included
+	struct SlabHeader
+	{
+		SlabHeader* m_next;
+		size m_size;
+		uint32 m_chunkCount;
+		uint32 m_freeCount;
+		bool m_owned;
+	};
+
+	static constexpr size kCellAlignment = Alignment > sizeof(SlabHeader*) ? Alignment : sizeof(SlabHeader*);
+
+public:
+	// is a pool allocator, array makes no sense, it is allocated already at construction time the full list and you get one by one
+	static constexpr bool kAllowedAllocationArray = false;
+
+	GrowingPoolAllocator(void* _start, void* _end, size _headerSize, size _footerSize) : m_slabs(nullptr), m_freeSlabCount(0), m_usedMemory(0), m_totalMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+		eosAssertReturnVoid((uintPtr)_end - (uintPtr)_start > sizeof(SlabHeader), "Area is too small for this allocator");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+		m_headerSize = _headerSize;
+
+		m_fullChunkSize = (ChunkSize + _headerSize + _footerSize);
+
+		// every cell is the slab pointer and the chunk, placed so the memory after the header is aligned
+		const size chunkSpace = m_fullChunkSize > sizeof(Node) ? m_fullChunkSize : sizeof(Node);
+		m_chunkOffset = CoreUtils::AlignTop(sizeof(SlabHeader*) + m_headerSize, Alignment) - m_headerSize;
+		m_cellStride = CoreUtils::AlignTop(m_chunkOffset + chunkSpace, kCellAlignment);
+		m_slabSize = GetFirstCell(0) + m_cellStride * ChunksPerSlab;
+
+		Reset();
+	}
+
+	~GrowingPoolAllocator()
+	{
+		SlabHeader* slab = m_slabs;
+		while (slab != nullptr)
+		{
+			SlabHeader* next = slab->m_next;
+			ReleaseSlab(slab);
+			slab = next;
+		}
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size /*_headerSize*/, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_size == m_fullChunkSize, nullptr, "Allocation size must be equal to chunk size");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(_alignment == Alignment, nullptr, "Alignment must be equal to alignment set");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+		(void)_size;
+		(void)_alignment;
+
+		Node* buffer = m_freeList.Pop();
+		if (buffer == nullptr)
+		{
+			if (!AddSlab())
+			{
+				eosAssert(false, "Growing Pool Allocator cannot allocate a new slab");
+				return nullptr;
+			}
+			buffer = m_freeList.Pop();
+		}
+
+		SlabHeader* slab = GetSlab(buffer);
+		if (slab->m_freeCount-- == slab->m_chunkCount && slab->m_owned)
+		{
+			--m_freeSlabCount;
+		}
+
+		m_usedMemory += m_fullChunkSize;
+
+		return (void*)buffer;
+	}
+
+	// the size is not used, because without the size in the header it is not known
+	EOS_INLINE void Free(void* _ptr, size /*_size*/)
+	{
+		m_usedMemory -= m_fullChunkSize;
+
+		m_freeList.Push((Node*)_ptr);
+
+		SlabHeader* slab = GetSlab(_ptr);
+		if (++slab->m_freeCount == slab->m_chunkCount && slab->m_owned)
+		{
+			++m_freeSlabCount;
+		}
+
+		if (ReleaseThresholdPercentage > 0 && m_freeSlabCount > 0 && m_usedMemory * 100 < m_totalMemory * ReleaseThresholdPercentage)
+		{
+			ReleaseFreeSlabs();
+		}
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return m_fullChunkSize;
+	}
+
+	// gives back all the slabs taken from the ChunkSource, only the area is left
+	EOS_INLINE void Reset()
+	{
+		SlabHeader* slab = m_slabs;
+		while (slab != nullptr)
+		{
+			SlabHeader* next = slab->m_next;
+			ReleaseSlab(slab);
+			slab = next;
+		}
+
+		m_slabs = nullptr;
+		m_freeList.SetHead(nullptr);
+		m_freeSlabCount = 0;
+		m_usedMemory = 0;
+		m_totalMemory = 0;
+
+		InitSlab((SlabHeader*)m_start, m_end - m_start, false);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemory;
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_totalMemory;
+	}
+
+private:
+	static EOS_INLINE SlabHeader* GetSlab(void* _chunk)
+	{
+		return *reinterpret_cast<SlabHeader**>((uintPtr)_chunk - sizeof(SlabHeader*));
+	}
+
+	EOS_INLINE uintPtr GetFirstCell(uintPtr _slab) const
+	{
+		return CoreUtils::AlignTop(_slab + sizeof(SlabHeader), kCellAlignment);
+	}
+
+	EOS_INLINE void ReleaseSlab(SlabHeader* _slab)
+	{
+		if (_slab->m_owned)
+		{
+			ChunkSource::FreeChunk(_slab, _slab->m_size);
+		}
+	}
+
+	void InitSlab(SlabHeader* _slab, size _size, bool _owned)
+	{
+		const uintPtr firstCell = GetFirstCell((uintPtr)_slab);
+		const uintPtr slabEnd = (uintPtr)_slab + _size;
+		const size chunkCount = firstCell < slabEnd ? (slabEnd - firstCell) / m_cellStride : 0;
+
+		_slab->m_next = m_slabs;
+		_slab->m_size = _size;
+		_slab->m_chunkCount = static_cast<uint32>(chunkCount);
+		_slab->m_freeCount = static_cast<uint32>(chunkCount);
+		_slab->m_owned = _owned;
+
+		// pushed from the last, so the chunks are given in address order
+		uint32 i = _slab->m_chunkCount;
+		while (i > 0)
+		{
+			--i;
+			const uintPtr chunk = firstCell + i * m_cellStride + m_chunkOffset;
+			*reinterpret_cast<SlabHeader**>(chunk - sizeof(SlabHeader*)) = _slab;
+			m_freeList.Push((Node*)chunk);
+		}
+
+		m_slabs = _slab;
+		m_totalMemory += _size;
+
+		if (_owned)
+		{
+			++m_freeSlabCount;
+		}
+	}
+
+	bool AddSlab()
+	{
+		SlabHeader* slab = (SlabHeader*)ChunkSource::AllocateChunk(m_slabSize);
+		if (slab == nullptr)
+		{
+			return false;
+		}
+
+		InitSlab(slab, m_slabSize, true);
+		return true;
+	}
+
+	// the free list is rebuilt without the chunks of the free slabs, then the free slabs are given back
+	void ReleaseFreeSlabs()
+	{
+		Node* head = nullptr;
+		Node* tail = nullptr;
+
+		Node* node = m_freeList.Pop();
+		while (node != nullptr)
+		{
+			const SlabHeader* slab = GetSlab(node);
+			Node* next = m_freeList.Pop();
+			if (!slab->m_owned || slab->m_freeCount != slab->m_chunkCount)
+			{
+				node->m_next = nullptr;
+				if (tail != nullptr)
+				{
+					tail->m_next = node;
+				}
+				else
+				{
+					head = node;
+				}
+				tail = node;
+			}
+			node = next;
+		}
+		m_freeList.SetHead(head);
+
+		SlabHeader** link = &m_slabs;
+		while (*link != nullptr)
+		{
+			SlabHeader* slab = *link;
+			if (slab->m_owned && slab->m_freeCount == slab->m_chunkCount)
+			{
+				*link = slab->m_next;
+				m_totalMemory -= slab->m_size;
+				ReleaseSlab(slab);
+			}
+			else
+			{
+				link = &slab->m_next;
+			}
+		}
+
+		m_freeSlabCount = 0;
+	}
+
+private:
+	StackLinkedList<FreeHeader> m_freeList;
+
+	SlabHeader* m_slabs;
+
+	uintPtr m_start;
+	uintPtr m_end;
+
+	uint32 m_freeSlabCount;
+
+	size m_headerSize;
+	size m_fullChunkSize;
+	size m_chunkOffset;
+	size m_cellStride;
+	size m_slabSize;
+	size m_usedMemory;
+	size m_totalMemory;
+};
+
+
+template<size ChunkSize, size Alignment, class ChunkSource = HeapChunkSource, uint32 ChunksPerSlab = 64, size ReleaseThresholdPercentage = 0>
+using GrowingPoolAllocationPolicy = AllocationPolicy<GrowingPoolAllocator<ChunkSize, Alignment, ChunkSource, ChunksPerSlab, ReleaseThresholdPercentage>, AllocationHeader>;
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -21,6 +21,12 @@ class LinearAllocator
 public:
 	static constexpr bool kAllowedAllocationArray = true;
 
+	// to continue from a snapshot of the area, see the MappedFileArea
+	struct State
+	{
+		uintPtr m_current;
+	};
+
 	LinearAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/)
 	{
 		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
@@ -30,6 +36,17 @@ public:
 		m_start = (uintPtr)_start;
 		m_end = (uintPtr)_end;
 		m_current = m_start;
+		m_last = 0;
+	}
+
+	LinearAllocator(void* _start, void* _end, size _headerSize, size _footerSize, const State* _state) : LinearAllocator(_start, _end, _headerSize, _footerSize)
+	{
+		if (_state != nullptr)
+		{
+			eosAssertReturnVoid(_state->m_current >= m_start && _state->m_current <= m_end, "State is not valid for this area");
+
+			m_current = _state->m_current;
+		}
 	}
 
 	~LinearAllocator()
@@ -43,15 +60,61 @@ public:
 		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
 		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
 
-		m_current = CoreUtils::AlignTop(m_current + _headerSize, _alignment) - _headerSize;
-		void* ptr = (void*)m_current;
+		const uintPtr address = CoreUtils::AlignTop(m_current + _headerSize, _alignment) - _headerSize;
 
-		m_current += _size;
+		// not only an assert, the allocator must never go past the end, also in release
+		if (address + _size >= m_end)
+		{
+			eosAssert(false, "Linear Allocator is out of memory");
+			return nullptr;
+		}
 
-		eosAssertReturnValue(ptr, nullptr, "Linear Allocator returned unexpected null");
-		eosAssertReturnValue(m_current < m_end, nullptr, "Linear Allocator is out of memory");
+		m_last = address;
+		m_current = address + _size;
 
-		return ptr;
+		return (void*)address;
+	}
+
+	// After the first one the blocks are at the same distance, so the whole run is carved at once
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, size _headerSize, size /*_footerSize*/, void** _out)
+	{
+		eosAssertReturnValue(_size > 0, 0, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, 0, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), 0, "Alignment must be power of 2");
+
+		if (_count == 0)
+		{
+			return 0;
+		}
+
+		const uintPtr first = CoreUtils::AlignTop(m_current + _headerSize, _alignment) - _headerSize;
+		const size stride = CoreUtils::AlignTop(_size, _alignment);
+
+		size count = 0;
+		if (first + _size < m_end)
+		{
+			const size fitting = (m_end - first - _size - 1) / stride + 1;
+			count = fitting < _count ? fitting : _count;
+		}
+
+		if (count < _count)
+		{
+			eosAssert(false, "Linear Allocator is out of memory");
+			if (count == 0)
+			{
+				return 0;
+			}
+		}
+
+		for (size i = 0; i < count; ++i)
+		{
+			_out[i] = (void*)(first + i * stride);
+		}
+
+		m_last = first + (count - 1) * stride;
+		m_current = m_last + _size;
+
+		return count;
 	}
 
 	// Cannot free a linear allocator
@@ -59,15 +122,63 @@ public:
 	{
 	}
 
-	// The linear allocator never store its own size
-	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	EOS_INLINE void FreeBatch(void* const* /*_ptrs*/, size /*_count*/, size /*_offset*/)
+	{
+	}
+
+	// The linear allocator never store its own size: it is exact for the most recent allocation,
+	// for the others it is the memory up to the current position, which the allocation is not bigger than
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		return m_current - (uintPtr)_ptr;
+	}
+
+	// Only the most recent allocation can be resized, moving the current position
+	EOS_INLINE bool TryExpandInPlace(void* _ptr, size /*_oldSize*/, size _newSize)
 	{
-		return 0;
+		if ((uintPtr)_ptr != m_last || m_last + _newSize >= m_end)
+		{
+			return false;
+		}
+
+		m_current = m_last + _newSize;
+		return true;
+	}
+
+	EOS_INLINE bool ShrinkInPlace(void* _ptr, size /*_oldSize*/, size _newSize)
+	{
+		if ((uintPtr)_ptr != m_last)
+		{
+			return false;
+		}
+
+		m_current = m_last + _newSize;
+		return true;
+	}
+
+	EOS_INLINE uintPtr GetMarker() const
+	{
+		return m_current;
+	}
+
+	// Releases everything allocated after the marker was taken
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		eosAssertReturnVoid(_marker >= m_start && _marker <= m_current, "Marker is not valid for this allocator");
+
+		m_current = _marker;
+		m_last = 0;
 	}
 
 	EOS_INLINE void Reset()
 	{
 		m_current = m_start;
+		m_last = 0;
+	}
+
+	EOS_INLINE void GetState(State& _state) const
+	{
+		_state.m_current = m_current;
 	}
 
 	EOS_INLINE size GetUsedMemory()  const
@@ -85,6 +196,7 @@ private:
 	uintPtr m_start;
 	uintPtr m_end;
 	uintPtr m_current;
+	uintPtr m_last;
 };
 
 
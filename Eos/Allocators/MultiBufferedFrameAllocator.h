@@ -0,0 +1,163 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\MultiBufferedFrameAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <atomic>
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// The area is divided in FrameCount linear arenas, the allocations go to the arena of the current frame.
+// AdvanceFrame moves to the next arena and resets it, so the data allocated in a frame stays valid for FrameCount frames.
+// When Concurrent is true the bump is an atomic compare and swap, so Allocate can be called from many threads at once
+// and the MemoryAllocator can use the SingleThreadPolicy, as long as the other policies used are thread safe as well.
+// AdvanceFrame and Reset are never thread safe, they must be called when nobody is allocating.
+template<uint32 FrameCount, bool Concurrent = false>
+class MultiBufferedFrameAllocator
+{
+private:
+	static_assert(FrameCount >= 2, "FrameCount must be at least 2");
+
+	struct Arena
+	{
+		std::atomic<uintPtr> m_current;
+		uintPtr m_start;
+		uintPtr m_end;
+	};
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	MultiBufferedFrameAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_frameIndex(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		const size arenaSize = (m_end - m_start) / FrameCount;
+		for (uint32 i = 0; i < FrameCount; ++i)
+		{
+			m_arenas[i].m_start = m_start + i * arenaSize;
+			m_arenas[i].m_end = m_arenas[i].m_start + arenaSize;
+		}
+
+		Reset();
+	}
+
+	~MultiBufferedFrameAllocator()
+	{
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+
+		Arena& arena = m_arenas[m_frameIndex];
+
+		uintPtr current = arena.m_current.load(std::memory_order_relaxed);
+		while (true)
+		{
+			const uintPtr address = CoreUtils::AlignTop(current + _headerSize, _alignment) - _headerSize;
+
+			// not only an assert, the arena must never go past the end, also in release
+			if (address > arena.m_end || arena.m_end - address < _size)
+			{
+				eosAssert(false, "Multi Buffered Frame Allocator is out of memory for this frame");
+				return nullptr;
+			}
+
+			if (!Concurrent)
+			{
+				arena.m_current.store(address + _size, std::memory_order_relaxed);
+				return (void*)address;
+			}
+
+			// on failure current is updated with the value set by the other thread
+			if (arena.m_current.compare_exchange_weak(current, address + _size, std::memory_order_relaxed, std::memory_order_relaxed))
+			{
+				return (void*)address;
+			}
+		}
+	}
+
+	// Single allocation cannot be freed, the arena is reset when its frame comes back
+	EOS_INLINE void Free(void* /*_ptr*/, size /*_size*/)
+	{
+	}
+
+	// The multi buffered frame allocator never store its own size
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return 0;
+	}
+
+	// Moves to the next frame, releasing the allocations made FrameCount frames ago
+	EOS_INLINE void AdvanceFrame()
+	{
+		m_frameIndex = (m_frameIndex + 1) % FrameCount;
+
+		Arena& arena = m_arenas[m_frameIndex];
+		arena.m_current.store(arena.m_start, std::memory_order_relaxed);
+	}
+
+	EOS_INLINE uint32 GetFrameIndex() const
+	{
+		return m_frameIndex;
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_frameIndex = 0;
+
+		for (uint32 i = 0; i < FrameCount; ++i)
+		{
+			m_arenas[i].m_current.store(m_arenas[i].m_start, std::memory_order_relaxed);
+		}
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		size usedMemory = 0;
+		for (uint32 i = 0; i < FrameCount; ++i)
+		{
+			usedMemory += m_arenas[i].m_current.load(std::memory_order_relaxed) - m_arenas[i].m_start;
+		}
+		return usedMemory;
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+
+private:
+	Arena m_arenas[FrameCount];
+
+	uintPtr m_start;
+	uintPtr m_end;
+
+	uint32 m_frameIndex;
+};
+
+
+template<uint32 FrameCount, bool Concurrent = false>
+using MultiBufferedFrameAllocationPolicy = AllocationPolicy<MultiBufferedFrameAllocator<FrameCount, Concurrent>, AllocationHeader>;
+
+EOS_NAMESPACE_END
\ No newline at end of file
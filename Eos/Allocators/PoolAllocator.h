@@ -37,6 +37,11 @@ public:
 
 		m_fullChunkSize = (ChunkSize + m_headerSize + m_footerSize);
 
+		// every chunk has to keep the memory after the header aligned, and has to be able to store the free list node when free
+		const size minChunkSize = m_fullChunkSize > sizeof(Node) ? m_fullChunkSize : sizeof(Node);
+		m_chunkStride = CoreUtils::AlignTop(minChunkSize, Alignment);
+		m_first = CoreUtils::AlignTop(m_start + m_headerSize, Alignment) - m_headerSize;
+
 		Reset();
 	}
 
@@ -69,6 +74,51 @@ public:
 		m_freeList.Push((Node*)_ptr);
 	}
 
+	// the chunks are taken from the free list in one walk, and its head is moved once
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, size /*_headerSize*/, size /*_footerSize*/, void** _out)
+	{
+		eosAssertReturnValue(_size == m_fullChunkSize, 0, "Allocation size must be equal to chunk size");
+		eosAssertReturnValue(_alignment == Alignment, 0, "Alignment must be equal to alignment set");
+		(void)_size;
+		(void)_alignment;
+
+		Node* node = m_freeList.GetHead();
+		size i = 0;
+		for (; i < _count && node != nullptr; ++i)
+		{
+			_out[i] = node;
+			node = node->m_next;
+		}
+		m_freeList.SetHead(node);
+
+		eosAssert(i == _count, "The allocator is full");
+
+		m_usedMemory += i * _size;
+
+		return i;
+	}
+
+	// the chunks are linked together first, then the run is pushed at once
+	EOS_INLINE void FreeBatch(void* const* _ptrs, size _count, size _offset)
+	{
+		if (_count == 0)
+		{
+			return;
+		}
+
+		Node* first = (Node*)((uintPtr)_ptrs[0] - _offset);
+		Node* last = first;
+		for (size i = 1; i < _count; ++i)
+		{
+			Node* node = (Node*)((uintPtr)_ptrs[i] - _offset);
+			last->m_next = node;
+			last = node;
+		}
+		m_freeList.PushRun(first, last);
+
+		m_usedMemory -= _count * m_fullChunkSize;
+	}
+
 	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
 	{
 		return m_fullChunkSize;
@@ -77,15 +127,15 @@ public:
 	EOS_INLINE void Reset()
 	{
 		m_usedMemory = 0;
-		m_current = m_start;
+		m_current = m_first;
+		m_freeList.SetHead(nullptr);
 
-		m_chunkCount = static_cast<uint32>(GetTotalMemory() / m_fullChunkSize);
+		m_chunkCount = static_cast<uint32>(m_first < m_end ? (m_end - m_first) / m_chunkStride : 0);
 		uint32 i = 0;
 		while (i < m_chunkCount)
 		{
-			uintPtr address = CoreUtils::AlignTop(m_current + m_headerSize, Alignment) - m_headerSize;
-			m_freeList.Push((Node*)address);
-			m_current += m_fullChunkSize;
+			m_freeList.Push((Node*)m_current);
+			m_current += m_chunkStride;
 			++i;
 		}
 	}
@@ -107,6 +157,7 @@ private:
 
 	uintPtr m_start;
 	uintPtr m_end;
+	uintPtr m_first;
 	uintPtr m_current;
 
 	uint32 m_chunkCount;
@@ -115,6 +166,7 @@ private:
 	size m_footerSize;
 	size m_usedMemory;
 	size m_fullChunkSize;
+	size m_chunkStride;
 };
 
 
@@ -0,0 +1,235 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\ScopeStackAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NoCopyable.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemCpy.h"
+#include "../MemoryAllocationPolicy.h"
+#include "../MemoryLayoutUtils.h"
+#include "../MemoryLogPolicy.h"
+
+#include "LinearAllocator.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// LinearAllocator which can be rewound to a marker taken before, releasing everything allocated after it.
+// Each allocation is linked to the previous one by a word before it, so the rewind can give the released allocations
+// to the MemoryAllocator, which checks them and reports them to the LogPolicy as freed.
+// Use it with the Scope below to have nested phases releasing their own temporaries.
+class ScopeStackAllocator
+{
+private:
+	static constexpr size kLinkSize = sizeof(uintPtr);
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	ScopeStackAllocator(void* _start, void* _end, size _headerSize, size _footerSize) : m_linear(_start, _end, _headerSize + kLinkSize, _footerSize), m_last(0)
+	{
+	}
+
+	~ScopeStackAllocator()
+	{
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size _footerSize)
+	{
+		// the link is before the header, so the memory after the header keeps its alignment
+		uint8* block = static_cast<uint8*>(m_linear.Allocate(_size + kLinkSize, _alignment, _headerSize + kLinkSize, _footerSize));
+		if (block == nullptr)
+		{
+			return nullptr;
+		}
+
+		MemUtils::MemCpy(block, &m_last, kLinkSize);
+		m_last = (uintPtr)block;
+
+		return block + kLinkSize;
+	}
+
+	// Single allocation cannot be freed, rewind to a marker instead
+	EOS_INLINE void Free(void* /*_ptr*/, size /*_size*/)
+	{
+	}
+
+	// The scope stack allocator never store its own size
+	EOS_INLINE size GetAllocatedSize(void* /*_ptr*/)
+	{
+		return 0;
+	}
+
+	EOS_INLINE uintPtr GetMarker() const
+	{
+		return m_linear.GetMarker();
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		while (PopAllocation(_marker) != nullptr)
+		{
+		}
+
+		m_linear.RewindTo(_marker);
+	}
+
+	// Unlinks the most recent allocation made after the marker and returns it, nullptr when there is none left.
+	// The memory is still there until the RewindTo.
+	EOS_INLINE void* PopAllocation(uintPtr _marker)
+	{
+		if (m_last == 0 || m_last < _marker)
+		{
+			return nullptr;
+		}
+
+		const uintPtr block = m_last;
+		MemUtils::MemCpy(&m_last, (void*)block, kLinkSize);
+
+		return (void*)(block + kLinkSize);
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_linear.Reset();
+		m_last = 0;
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_linear.GetUsedMemory();
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_linear.GetTotalMemory();
+	}
+
+
+private:
+	LinearAllocator m_linear;
+	uintPtr m_last;
+};
+
+
+using ScopeStackAllocationPolicy = AllocationPolicy<ScopeStackAllocator, AllocationHeader>;
+
+
+// RAII scope over an allocator supporting the markers: takes the marker when opened, and when closed
+// calls the destructors of the objects created in it, in reverse order, and rewinds the allocator to the marker.
+// The trivially destructible objects do not register any destructor.
+// Scopes must be closed in reverse order of opening, and nothing else should allocate from the allocator while a nested scope is open.
+template<class Allocator>
+class Scope : public NoCopyableMoveable
+{
+private:
+	struct Finalizer
+	{
+		void(*m_destructor)(void*);
+		void* m_object;
+		Finalizer* m_next;
+	};
+
+public:
+	Scope(Allocator* _allocator) : m_allocator(_allocator), m_marker(_allocator->GetMarker()), m_finalizers(nullptr)
+	{
+	}
+
+	~Scope()
+	{
+		for (Finalizer* finalizer = m_finalizers; finalizer != nullptr; finalizer = finalizer->m_next)
+		{
+			finalizer->m_destructor(finalizer->m_object);
+		}
+
+		m_allocator->RewindTo(m_marker);
+	}
+
+	template<typename T, typename... Args>
+	EOS_INLINE T* New(const LogSourceInfo& _sourceInfo, Args&&... _args)
+	{
+		constexpr bool isTriviallyDestructible = std::is_trivially_destructible<T>::value;
+
+		// a finalizer without its object is never registered, it is released with the scope
+		Finalizer* finalizer = AllocateFinalizer<T>(_sourceInfo, MemUtils::IntToType<isTriviallyDestructible>());
+		if (!isTriviallyDestructible && finalizer == nullptr)
+		{
+			return nullptr;
+		}
+
+		void* buffer = m_allocator->Allocate(sizeof(T), alignof(T), _sourceInfo);
+		if (buffer == nullptr)
+		{
+			return nullptr;
+		}
+
+		T* object = new (buffer) T(std::forward<Args>(_args)...);
+
+		RegisterFinalizer(finalizer, object);
+
+		return object;
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		return m_allocator->Allocate(_size, _alignment, _sourceInfo);
+	}
+
+private:
+	template<typename T>
+	static void Destroy(void* _object)
+	{
+		static_cast<T*>(_object)->~T();
+	}
+
+	template<typename T>
+	EOS_INLINE Finalizer* AllocateFinalizer(const LogSourceInfo& _sourceInfo, MemUtils::IntToType<false>)
+	{
+		Finalizer* finalizer = static_cast<Finalizer*>(m_allocator->Allocate(sizeof(Finalizer), alignof(Finalizer), _sourceInfo));
+		if (finalizer == nullptr)
+		{
+			return nullptr;
+		}
+
+		finalizer->m_destructor = &Scope::Destroy<T>;
+		return finalizer;
+	}
+
+	template<typename T>
+	EOS_INLINE Finalizer* AllocateFinalizer(const LogSourceInfo&, MemUtils::IntToType<true>)
+	{
+		return nullptr;
+	}
+
+	EOS_INLINE void RegisterFinalizer(Finalizer* _finalizer, void* _object)
+	{
+		if (_finalizer != nullptr)
+		{
+			_finalizer->m_object = _object;
+			_finalizer->m_next = m_finalizers;
+			m_finalizers = _finalizer;
+		}
+	}
+
+private:
+	Allocator* m_allocator;
+	uintPtr m_marker;
+	Finalizer* m_finalizers;
+};
+
+
+EOS_NAMESPACE_END
+
+
+#define eosNewScoped(Type, Scope, ...)	(Scope)->template New<Type>(EOS_ALLOCATION_INFO, ##__VA_ARGS__)
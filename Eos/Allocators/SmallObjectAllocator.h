@@ -0,0 +1,309 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\SmallObjectAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+#include "../DataStructures/StackLinkedList.h"
+
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+namespace SmallObjectUtils
+{
+	static constexpr size kSizeClasses[] =
+	{
+		16, 24, 32, 48, 64, 80, 96, 112, 128,
+		160, 192, 224, 256, 320, 384, 448, 512,
+		640, 768, 896, 1024
+	};
+
+	static constexpr uint32 kSizeClassCount = sizeof(kSizeClasses) / sizeof(kSizeClasses[0]);
+	static constexpr size kMaxSmallObjectSize = kSizeClasses[kSizeClassCount - 1];
+	static constexpr size kSizeClassGranularity = 8;
+	static constexpr size kMaxSizeClassAlignment = 16;
+
+	// size (in step of kSizeClassGranularity) to size class index, built at compile time
+	struct SizeClassTable
+	{
+		constexpr SizeClassTable() : m_classIndex()
+		{
+			uint32 sizeClass = 0;
+			for (size i = 0; i <= kMaxSmallObjectSize / kSizeClassGranularity; ++i)
+			{
+				while (kSizeClasses[sizeClass] < i * kSizeClassGranularity)
+				{
+					++sizeClass;
+				}
+				m_classIndex[i] = static_cast<uint8>(sizeClass);
+			}
+		}
+
+		uint8 m_classIndex[kMaxSmallObjectSize / kSizeClassGranularity + 1];
+	};
+
+	static constexpr SizeClassTable kSizeClassTable;
+
+	static constexpr EOS_INLINE uint32 GetSizeClass(size _size)
+	{
+		return kSizeClassTable.m_classIndex[(_size + kSizeClassGranularity - 1) / kSizeClassGranularity];
+	}
+
+	// the chunks of a class are placed every class size, so the alignment is the lowest power of 2 of the class size
+	static constexpr EOS_INLINE size GetSizeClassAlignment(uint32 _sizeClass)
+	{
+		return (kSizeClasses[_sizeClass] & (~kSizeClasses[_sizeClass] + 1)) < kMaxSizeClassAlignment ? (kSizeClasses[_sizeClass] & (~kSizeClasses[_sizeClass] + 1)) : kMaxSizeClassAlignment;
+	}
+}
+
+
+// Segregated size class allocator for small objects
+// The first part of the area is divided in slabs of SlabSize, each slab is assigned on demand to one size class and used as a pool.
+// The rest of the area is given to the FallbackAllocator, which serves the allocations bigger than the biggest size class,
+// with an alignment not supported by the classes or when the slabs are over.
+// The owner of a pointer is found by address, so no header is needed for the small objects.
+template<typename FallbackAllocator, size SmallObjectAreaPercentage = 50, size SlabSize = 16 * 1024>
+class SmallObjectAllocator
+{
+private:
+	static_assert(CoreUtils::IsPowerOf2(SlabSize), "SlabSize must be power of 2");
+	static_assert(SlabSize >= SmallObjectUtils::kMaxSmallObjectSize * 2, "SlabSize must hold more than one object of the biggest size class");
+	static_assert(SmallObjectAreaPercentage > 0 && SmallObjectAreaPercentage < 100, "SmallObjectAreaPercentage must be in the range ]0, 100[");
+
+	struct FreeHeader {};
+	using Node = typename StackLinkedList<FreeHeader>::Node;
+
+	static_assert(SmallObjectUtils::kSizeClasses[0] >= sizeof(Node), "The smallest size class must be able to store a free list node");
+
+	struct SizeClass
+	{
+		StackLinkedList<FreeHeader> m_freeList;
+		uintPtr m_current;
+		uintPtr m_end;
+	};
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	SmallObjectAllocator(void* _start, void* _end, size _headerSize, size _footerSize) :
+		m_fallback(GetFallbackStart(_start, _end), _end, _headerSize, _footerSize),
+		m_headerSize(_headerSize),
+		m_usedMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		// the slab owner table is at the beginning, one byte for each slab
+		const uintPtr fallbackStart = (uintPtr)GetFallbackStart(_start, _end);
+		// the table size is an upper bound, the slabs are counted again after the alignment of their start and never exceed the table
+		const size tableSize = (fallbackStart - m_start) / (SlabSize + 1);
+
+		m_slabSizeClasses = (uint8*)m_start;
+		m_slabStart = CoreUtils::AlignTop(m_start + tableSize, SmallObjectUtils::kMaxSizeClassAlignment);
+
+		size slabCount = m_slabStart < fallbackStart ? (fallbackStart - m_slabStart) / SlabSize : 0;
+		slabCount = slabCount < tableSize ? slabCount : tableSize;
+		m_slabEnd = m_slabStart + slabCount * SlabSize;
+
+		Reset();
+	}
+
+	~SmallObjectAllocator()
+	{
+
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size _footerSize)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+
+		if (_size <= SmallObjectUtils::kMaxSmallObjectSize && _alignment <= SmallObjectUtils::kMaxSizeClassAlignment && _headerSize == m_headerSize)
+		{
+			const uint32 sizeClass = GetAlignedSizeClass(_size, _alignment);
+			if (sizeClass < SmallObjectUtils::kSizeClassCount)
+			{
+				void* ptr = AllocateFromSizeClass(sizeClass);
+				if (ptr != nullptr)
+				{
+					m_usedMemory += SmallObjectUtils::kSizeClasses[sizeClass];
+					return ptr;
+				}
+			}
+		}
+
+		return m_fallback.Allocate(_size, _alignment, _headerSize, _footerSize);
+	}
+
+	EOS_INLINE void Free(void* _ptr, size _size)
+	{
+		const uintPtr address = (uintPtr)_ptr;
+		if (IsSmallObject(address))
+		{
+			const uint32 sizeClass = m_slabSizeClasses[(address - m_slabStart) / SlabSize];
+			m_sizeClasses[sizeClass].m_freeList.Push((Node*)_ptr);
+			m_usedMemory -= SmallObjectUtils::kSizeClasses[sizeClass];
+		}
+		else
+		{
+			m_fallback.Free(_ptr, _size);
+		}
+	}
+
+	// the size class comes from the size as in Allocate, so the slab owner table is not read
+	EOS_INLINE void FreeSized(void* _ptr, size _size, size _alignment, size _headerSize)
+	{
+		const uintPtr address = (uintPtr)_ptr;
+		if (IsSmallObject(address))
+		{
+			const uint32 sizeClass = GetAlignedSizeClass(_size, _alignment);
+
+			eosAssertReturnVoid(sizeClass == m_slabSizeClasses[(address - m_slabStart) / SlabSize], "The size or the alignment given to Free are not the ones of the allocation");
+
+			m_sizeClasses[sizeClass].m_freeList.Push((Node*)_ptr);
+			m_usedMemory -= SmallObjectUtils::kSizeClasses[sizeClass];
+		}
+		else
+		{
+			FreeFallback(_ptr, _size, _alignment, _headerSize, MemUtils::IntToType<MemUtils::HasSizedFree<FallbackAllocator>::value>());
+		}
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		const uintPtr address = (uintPtr)_ptr;
+		if (IsSmallObject(address))
+		{
+			return SmallObjectUtils::kSizeClasses[m_slabSizeClasses[(address - m_slabStart) / SlabSize]];
+		}
+		return m_fallback.GetAllocatedSize(_ptr);
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_usedMemory = 0;
+		m_slabCurrent = m_slabStart;
+
+		for (uint32 i = 0; i < SmallObjectUtils::kSizeClassCount; ++i)
+		{
+			m_sizeClasses[i].m_freeList.SetHead(nullptr);
+			m_sizeClasses[i].m_current = 0;
+			m_sizeClasses[i].m_end = 0;
+		}
+
+		m_fallback.Reset();
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemory + m_fallback.GetUsedMemory();
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+private:
+	static EOS_INLINE void* GetFallbackStart(void* _start, void* _end)
+	{
+		const uintPtr start = (uintPtr)_start;
+		const uintPtr end = (uintPtr)_end;
+		return (void*)(start + ((end - start) / 100) * SmallObjectAreaPercentage);
+	}
+
+	EOS_INLINE bool IsSmallObject(uintPtr _address) const
+	{
+		return _address >= m_slabStart && _address < m_slabCurrent;
+	}
+
+	// the first class big enough with the alignment requested
+	static EOS_INLINE uint32 GetAlignedSizeClass(size _size, size _alignment)
+	{
+		uint32 sizeClass = SmallObjectUtils::GetSizeClass(_size);
+		while (sizeClass < SmallObjectUtils::kSizeClassCount && SmallObjectUtils::GetSizeClassAlignment(sizeClass) < _alignment)
+		{
+			++sizeClass;
+		}
+		return sizeClass;
+	}
+
+	EOS_INLINE void FreeFallback(void* _ptr, size _size, size _alignment, size _headerSize, MemUtils::IntToType<true>)
+	{
+		m_fallback.FreeSized(_ptr, _size, _alignment, _headerSize);
+	}
+
+	EOS_INLINE void FreeFallback(void* _ptr, size _size, size, size, MemUtils::IntToType<false>)
+	{
+		m_fallback.Free(_ptr, _size);
+	}
+
+	// free list first, then the rest of the current slab of the class and at last a new slab
+	EOS_INLINE void* AllocateFromSizeClass(uint32 _sizeClass)
+	{
+		SizeClass& sizeClass = m_sizeClasses[_sizeClass];
+
+		Node* node = sizeClass.m_freeList.Pop();
+		if (node != nullptr)
+		{
+			return (void*)node;
+		}
+
+		const size chunkSize = SmallObjectUtils::kSizeClasses[_sizeClass];
+		if (sizeClass.m_current + chunkSize > sizeClass.m_end)
+		{
+			if (m_slabCurrent + SlabSize > m_slabEnd)
+			{
+				return nullptr;
+			}
+
+			const uintPtr slab = m_slabCurrent;
+			m_slabCurrent += SlabSize;
+			m_slabSizeClasses[(slab - m_slabStart) / SlabSize] = static_cast<uint8>(_sizeClass);
+
+			// the chunks are placed so the memory after the header is aligned to the class alignment
+			const size alignment = SmallObjectUtils::GetSizeClassAlignment(_sizeClass);
+			sizeClass.m_current = CoreUtils::AlignTop(slab + m_headerSize, alignment) - m_headerSize;
+			sizeClass.m_end = slab + SlabSize;
+		}
+
+		void* ptr = (void*)sizeClass.m_current;
+		sizeClass.m_current += chunkSize;
+		return ptr;
+	}
+
+private:
+	FallbackAllocator m_fallback;
+
+	SizeClass m_sizeClasses[SmallObjectUtils::kSizeClassCount];
+
+	uint8* m_slabSizeClasses;
+
+	uintPtr m_start;
+	uintPtr m_end;
+	uintPtr m_slabStart;
+	uintPtr m_slabEnd;
+	uintPtr m_slabCurrent;
+
+	size m_headerSize;
+	size m_usedMemory;
+};
+
+
+template<typename FallbackAllocator, size SmallObjectAreaPercentage = 50, size SlabSize = 16 * 1024>
+using SmallObjectAllocationPolicy = AllocationPolicy<SmallObjectAllocator<FallbackAllocator, SmallObjectAreaPercentage, SlabSize>, AllocationHeader>;
+
+EOS_NAMESPACE_END
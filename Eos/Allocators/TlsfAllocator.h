@@ -0,0 +1,404 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\TlsfAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Two-Level Segregated Fit allocator
+// The free blocks are stored in a matrix of lists indexed by a first level (power of 2 of the size) and
+// a second level (linear subdivision of the first level), each level has a bitmap of the not empty lists.
+// The lookup is made using the find first/last set bit, so allocation, free and coalescence are O(1).
+class TlsfAllocator
+{
+private:
+	// m_prevPhysical and m_sizeAndFlags are always valid, the free list links are used only when the block is free
+	// and overlap the payload when the block is used
+	struct Block
+	{
+		Block* m_prevPhysical;
+		size m_sizeAndFlags;
+		Block* m_nextFree;
+		Block* m_prevFree;
+	};
+
+	struct AllocationHeader
+	{
+		size m_padding;
+	};
+
+	static constexpr size kBlockFreeBit = 1;
+
+	static constexpr uint32 kAlignSizeLog2 = sizeof(void*) == 8 ? 4 : 3;
+	static constexpr size kAlignSize = static_cast<size>(1) << kAlignSizeLog2;
+
+	static constexpr uint32 kSLIndexCountLog2 = 5;
+	static constexpr uint32 kSLIndexCount = 1 << kSLIndexCountLog2;
+
+	static constexpr uint32 kFLIndexShift = kSLIndexCountLog2 + kAlignSizeLog2;
+	static constexpr uint32 kFLIndexMax = sizeof(void*) == 8 ? 38 : 30;
+	static constexpr uint32 kFLIndexCount = kFLIndexMax - kFLIndexShift + 1;
+
+	static constexpr size kSmallBlockSize = static_cast<size>(1) << kFLIndexShift;
+
+	static constexpr size kBlockOverhead = sizeof(Block*) + sizeof(size);
+	static constexpr size kBlockSizeMin = sizeof(Block) - kBlockOverhead;
+	static constexpr size kBlockSizeMax = static_cast<size>(1) << kFLIndexMax;
+
+	static constexpr size kAllocationHeaderSize = sizeof(AllocationHeader);
+
+	static_assert(kBlockOverhead % kAlignSize == 0, "Block overhead must keep the payload aligned");
+	static_assert(kBlockSizeMin % kAlignSize == 0, "Minimum block size must be a multiple of the align size");
+
+public:
+	static constexpr bool kAllowedAllocationArray = true;
+
+	TlsfAllocator(void* _start, void* _end, size /*_headerSize*/, size /*_footerSize*/) : m_usedMemory(0)
+	{
+		eosAssertReturnVoid(_start != nullptr, "start pointer is invalid");
+		eosAssertReturnVoid(_end != nullptr, "end pointer is invalid");
+		eosAssertReturnVoid(_start < _end, "end is greater than start");
+
+		m_start = (uintPtr)_start;
+		m_end = (uintPtr)_end;
+
+		Reset();
+	}
+
+	~TlsfAllocator()
+	{
+
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size /*_footerSize*/)
+	{
+		eosAssertReturnValue(_size > 0, nullptr, "Size must be greater then 0");
+		eosAssertReturnValue(_alignment > 0, nullptr, "Alignment must be greater then 0");
+		eosAssertReturnValue(CoreUtils::IsPowerOf2(_alignment), nullptr, "Alignment must be power of 2");
+
+		// the payload is always aligned to kAlignSize, so for small alignments the padding is known in advance,
+		// otherwise reserve the worst case and give back what is not used after the block is found
+		const size padding = _alignment <= kAlignSize ?
+			CoreUtils::AlignTop(kAllocationHeaderSize + _headerSize, _alignment) - _headerSize :
+			kAllocationHeaderSize + _alignment - 1;
+
+		const size requestSize = AdjustSize(_size + padding);
+
+		if (requestSize >= kBlockSizeMax)
+		{
+			eosAssert(false, "Requested size is too big for this allocator");
+			return nullptr;
+		}
+
+		Block* block = LocateFreeBlock(requestSize);
+
+		if (block == nullptr)
+		{
+			eosAssert(false, "Memory over, please resize the allocator!");
+			return nullptr;
+		}
+
+		const uintPtr payload = GetPayload(block);
+		const uintPtr dataAddress = CoreUtils::AlignTop(payload + kAllocationHeaderSize + _headerSize, _alignment) - _headerSize;
+		const size usedSize = AdjustSize(dataAddress - payload + _size);
+
+		Split(block, usedSize);
+		SetUsed(block);
+
+		((AllocationHeader*)(dataAddress - kAllocationHeaderSize))->m_padding = dataAddress - payload;
+
+		m_usedMemory += GetBlockSize(block) + kBlockOverhead;
+
+		return (void*)dataAddress;
+	}
+
+	EOS_INLINE void Free(void* _ptr, size /*_size*/)
+	{
+		Block* block = GetBlockFromData(_ptr);
+
+		eosAssertReturnVoid(!IsFree(block), "Block already freed");
+
+		m_usedMemory -= GetBlockSize(block) + kBlockOverhead;
+
+		SetFree(block);
+		block = MergePrev(block);
+		block = MergeNext(block);
+		InsertFreeBlock(block);
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		const Block* block = GetBlockFromData(_ptr);
+
+		// remove the padding, because outside is expecting the allocated plain memory
+		return GetBlockSize(block) - ((const AllocationHeader*)((uintPtr)_ptr - kAllocationHeaderSize))->m_padding;
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_usedMemory = 0;
+		m_flBitmap = 0;
+		for (uint32 i = 0; i < kFLIndexCount; ++i)
+		{
+			m_slBitmap[i] = 0;
+			for (uint32 j = 0; j < kSLIndexCount; ++j)
+			{
+				m_blocks[i][j] = nullptr;
+			}
+		}
+
+		// one block for the whole memory and a zero sized "used" sentinel at the end, so the last block never look outside the area
+		const uintPtr first = CoreUtils::AlignTop(m_start, kAlignSize);
+		const uintPtr last = (m_end - kBlockOverhead) & ~(kAlignSize - 1);
+
+		eosAssertReturnVoid(first + kBlockOverhead + kBlockSizeMin <= last, "Area is too small for this allocator");
+
+		Block* block = (Block*)first;
+		block->m_prevPhysical = nullptr;
+		SetBlockSize(block, last - first - kBlockOverhead);
+		SetFree(block);
+
+		Block* sentinel = (Block*)last;
+		sentinel->m_prevPhysical = block;
+		sentinel->m_sizeAndFlags = 0;
+
+		InsertFreeBlock(block);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_usedMemory;
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_end - m_start;
+	}
+
+private:
+	static EOS_INLINE size AdjustSize(size _size)
+	{
+		const size aligned = CoreUtils::AlignTop(_size, kAlignSize);
+		return aligned < kBlockSizeMin ? kBlockSizeMin : aligned;
+	}
+
+	static EOS_INLINE size GetBlockSize(const Block* _block) { return _block->m_sizeAndFlags & ~kBlockFreeBit; }
+	static EOS_INLINE void SetBlockSize(Block* _block, size _size) { _block->m_sizeAndFlags = _size | (_block->m_sizeAndFlags & kBlockFreeBit); }
+	static EOS_INLINE bool IsFree(const Block* _block) { return (_block->m_sizeAndFlags & kBlockFreeBit) != 0; }
+	static EOS_INLINE void SetFree(Block* _block) { _block->m_sizeAndFlags |= kBlockFreeBit; }
+	static EOS_INLINE void SetUsed(Block* _block) { _block->m_sizeAndFlags &= ~kBlockFreeBit; }
+
+	static EOS_INLINE uintPtr GetPayload(const Block* _block) { return (uintPtr)_block + kBlockOverhead; }
+	static EOS_INLINE Block* GetNextPhysical(const Block* _block) { return (Block*)(GetPayload(_block) + GetBlockSize(_block)); }
+
+	static EOS_INLINE Block* GetBlockFromData(const void* _ptr)
+	{
+		const size padding = ((const AllocationHeader*)((uintPtr)_ptr - kAllocationHeaderSize))->m_padding;
+		return (Block*)((uintPtr)_ptr - padding - kBlockOverhead);
+	}
+
+	// first level is the power of 2 of the size, second level is the linear subdivision of it
+	static EOS_INLINE void MappingInsert(size _size, uint32& _fl, uint32& _sl)
+	{
+		if (_size < kSmallBlockSize)
+		{
+			_fl = 0;
+			_sl = static_cast<uint32>(_size) / (kSmallBlockSize / kSLIndexCount);
+		}
+		else
+		{
+			const uint32 fl = CoreUtils::FindLastSet64(static_cast<uint64>(_size));
+			_sl = static_cast<uint32>(_size >> (fl - kSLIndexCountLog2)) ^ (1 << kSLIndexCountLog2);
+			_fl = fl - (kFLIndexShift - 1);
+		}
+	}
+
+	// round up to the next list, so any block found there is big enough
+	static EOS_INLINE void MappingSearch(size _size, uint32& _fl, uint32& _sl)
+	{
+		if (_size >= kSmallBlockSize)
+		{
+			const size round = (static_cast<size>(1) << (CoreUtils::FindLastSet64(static_cast<uint64>(_size)) - kSLIndexCountLog2)) - 1;
+			_size += round;
+		}
+		MappingInsert(_size, _fl, _sl);
+	}
+
+	EOS_INLINE Block* LocateFreeBlock(size _size)
+	{
+		uint32 fl = 0;
+		uint32 sl = 0;
+		MappingSearch(_size, fl, sl);
+
+		if (fl >= kFLIndexCount)
+		{
+			return LocateFreeBlockInList(_size);
+		}
+
+		uint32 slMap = m_slBitmap[fl] & (~0u << sl);
+		if (slMap == 0)
+		{
+			const uint32 flMap = m_flBitmap & (~0u << (fl + 1));
+			if (flMap == 0)
+			{
+				return LocateFreeBlockInList(_size);
+			}
+
+			fl = CoreUtils::FindFirstSet(flMap);
+			slMap = m_slBitmap[fl];
+		}
+		sl = CoreUtils::FindFirstSet(slMap);
+
+		Block* block = m_blocks[fl][sl];
+		RemoveFreeBlock(block, fl, sl);
+		return block;
+	}
+
+	// last chance when the rounded search fails: the list the size belongs to can still have a block big enough,
+	// only the head is checked to keep it O(1)
+	EOS_INLINE Block* LocateFreeBlockInList(size _size)
+	{
+		uint32 fl = 0;
+		uint32 sl = 0;
+		MappingInsert(_size, fl, sl);
+
+		if (fl >= kFLIndexCount)
+		{
+			return nullptr;
+		}
+
+		Block* block = m_blocks[fl][sl];
+		if (block == nullptr || GetBlockSize(block) < _size)
+		{
+			return nullptr;
+		}
+
+		RemoveFreeBlock(block, fl, sl);
+		return block;
+	}
+
+	EOS_INLINE void InsertFreeBlock(Block* _block)
+	{
+		uint32 fl = 0;
+		uint32 sl = 0;
+		MappingInsert(GetBlockSize(_block), fl, sl);
+
+		Block* head = m_blocks[fl][sl];
+		_block->m_nextFree = head;
+		_block->m_prevFree = nullptr;
+		if (head != nullptr)
+		{
+			head->m_prevFree = _block;
+		}
+		m_blocks[fl][sl] = _block;
+
+		m_flBitmap |= (1u << fl);
+		m_slBitmap[fl] |= (1u << sl);
+	}
+
+	EOS_INLINE void RemoveFreeBlock(Block* _block, uint32 _fl, uint32 _sl)
+	{
+		Block* prev = _block->m_prevFree;
+		Block* next = _block->m_nextFree;
+		if (next != nullptr)
+		{
+			next->m_prevFree = prev;
+		}
+		if (prev != nullptr)
+		{
+			prev->m_nextFree = next;
+		}
+
+		if (m_blocks[_fl][_sl] == _block)
+		{
+			m_blocks[_fl][_sl] = next;
+			if (next == nullptr)
+			{
+				m_slBitmap[_fl] &= ~(1u << _sl);
+				if (m_slBitmap[_fl] == 0)
+				{
+					m_flBitmap &= ~(1u << _fl);
+				}
+			}
+		}
+	}
+
+	EOS_INLINE void RemoveFreeBlock(Block* _block)
+	{
+		uint32 fl = 0;
+		uint32 sl = 0;
+		MappingInsert(GetBlockSize(_block), fl, sl);
+		RemoveFreeBlock(_block, fl, sl);
+	}
+
+	// trim the block to _size and give back the remaining part as a new free block
+	EOS_INLINE void Split(Block* _block, size _size)
+	{
+		const size blockSize = GetBlockSize(_block);
+		if (blockSize < _size + kBlockOverhead + kBlockSizeMin)
+		{
+			return;
+		}
+
+		Block* remaining = (Block*)(GetPayload(_block) + _size);
+		remaining->m_prevPhysical = _block;
+		remaining->m_sizeAndFlags = (blockSize - _size - kBlockOverhead) | kBlockFreeBit;
+		GetNextPhysical(remaining)->m_prevPhysical = remaining;
+
+		SetBlockSize(_block, _size);
+
+		// the next physical block is always used here, otherwise would have been coalesced already
+		InsertFreeBlock(remaining);
+	}
+
+	EOS_INLINE Block* MergePrev(Block* _block)
+	{
+		Block* prev = _block->m_prevPhysical;
+		if (prev != nullptr && IsFree(prev))
+		{
+			RemoveFreeBlock(prev);
+			SetBlockSize(prev, GetBlockSize(prev) + kBlockOverhead + GetBlockSize(_block));
+			GetNextPhysical(prev)->m_prevPhysical = prev;
+			return prev;
+		}
+		return _block;
+	}
+
+	EOS_INLINE Block* MergeNext(Block* _block)
+	{
+		Block* next = GetNextPhysical(_block);
+		if (IsFree(next))
+		{
+			RemoveFreeBlock(next);
+			SetBlockSize(_block, GetBlockSize(_block) + kBlockOverhead + GetBlockSize(next));
+			GetNextPhysical(_block)->m_prevPhysical = _block;
+		}
+		return _block;
+	}
+
+private:
+	Block* m_blocks[kFLIndexCount][kSLIndexCount];
+	uint32 m_slBitmap[kFLIndexCount];
+	uint32 m_flBitmap;
+
+	uintPtr m_start;
+	uintPtr m_end;
+
+	size m_usedMemory;
+};
+
+
+using TlsfAllocationPolicy = AllocationPolicy<TlsfAllocator, AllocationHeader>;
+
+EOS_NAMESPACE_END
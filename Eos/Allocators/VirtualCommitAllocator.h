@@ -0,0 +1,149 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\Allocators\VirtualCommitAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "../Core/BasicTypes.h"
+#include "../Core/Assertions.h"
+#include "../Core/NumberUtils.h"
+#include "../Core/PointerUtils.h"
+
+#include "../MemoryVirtualUtils.h"
+#include "../MemoryAllocationPolicy.h"
+
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Commits the memory of a reserved area (the VirtualArea) as the high water mark of the wrapped allocator grows,
+// CommitGranularity bytes at the time, and Reset decommits all of it but the first step.
+// Only for the allocators giving the memory of the area from the start upward and not touching it before, such the LinearAllocator.
+// The ScopeStackAllocator writes its links in Allocate, and the GrowingLinearAllocator takes its next chunks outside the area,
+// so they cannot be wrapped. Only the memory inside the area is committed.
+// The pages are committed and decommitted here and not through the VirtualArea, which must not decommit them by hand.
+template<class ActualAllocator, size CommitGranularity = 64 * 1024>
+class VirtualCommitAllocator
+{
+public:
+	static constexpr bool kAllowedAllocationArray = ActualAllocator::kAllowedAllocationArray;
+
+	VirtualCommitAllocator(void* _start, void* _end, size _headerSize, size _footerSize) :
+		m_start((uintPtr)_start),
+		m_end((uintPtr)_end),
+		m_commitGranularity(CoreUtils::AlignTop(CommitGranularity, MemUtils::GetVirtualPageSize())),
+		m_committedEnd(CommitFirstStep((uintPtr)_start, (uintPtr)_end, m_commitGranularity)),
+		m_allocator(_start, _end, _headerSize, _footerSize)
+	{
+		eosAssertReturnVoid(CoreUtils::AlignTop(m_start, MemUtils::GetVirtualPageSize()) == m_start, "start pointer must be aligned to the page size");
+	}
+
+	~VirtualCommitAllocator()
+	{
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, size _headerSize, size _footerSize)
+	{
+		void* ptr = m_allocator.Allocate(_size, _alignment, _headerSize, _footerSize);
+		if (ptr != nullptr && (uintPtr)ptr >= m_start && (uintPtr)ptr < m_end && (uintPtr)ptr + _size > m_committedEnd)
+		{
+			if (!Commit((uintPtr)ptr + _size))
+			{
+				eosAssert(false, "Cannot commit the virtual memory");
+				return nullptr;
+			}
+		}
+		return ptr;
+	}
+
+	EOS_INLINE void Free(void* _ptr, size _size)
+	{
+		m_allocator.Free(_ptr, _size);
+	}
+
+	EOS_INLINE size GetAllocatedSize(void* _ptr)
+	{
+		return m_allocator.GetAllocatedSize(_ptr);
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_allocator.Reset();
+
+		const uintPtr firstStepEnd = GetStepEnd(m_start + 1);
+		if (firstStepEnd < m_committedEnd)
+		{
+			MemUtils::DecommitVirtualMemory((void*)firstStepEnd, m_committedEnd - firstStepEnd);
+			m_committedEnd = firstStepEnd;
+		}
+	}
+
+	EOS_INLINE uintPtr GetMarker() const
+	{
+		return m_allocator.GetMarker();
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		m_allocator.RewindTo(_marker);
+	}
+
+	EOS_INLINE size GetUsedMemory()  const
+	{
+		return m_allocator.GetUsedMemory();
+	}
+
+	EOS_INLINE size GetTotalMemory() const
+	{
+		return m_allocator.GetTotalMemory();
+	}
+
+	EOS_INLINE size GetCommittedMemory() const
+	{
+		return m_committedEnd - m_start;
+	}
+
+private:
+	static uintPtr CommitFirstStep(uintPtr _start, uintPtr _end, size _commitGranularity)
+	{
+		const uintPtr end = _end - _start > _commitGranularity ? _start + _commitGranularity : _end;
+		return MemUtils::CommitVirtualMemory((void*)_start, end - _start) ? end : _start;
+	}
+
+	EOS_INLINE uintPtr GetStepEnd(uintPtr _address) const
+	{
+		const uintPtr end = m_start + CoreUtils::AlignTop(_address - m_start, m_commitGranularity);
+		return end < m_end ? end : m_end;
+	}
+
+	EOS_INLINE bool Commit(uintPtr _address)
+	{
+		eosAssertReturnValue(_address <= m_end, false, "Cannot commit outside the area");
+
+		const uintPtr end = GetStepEnd(_address);
+		if (!MemUtils::CommitVirtualMemory((void*)m_committedEnd, end - m_committedEnd))
+		{
+			return false;
+		}
+
+		m_committedEnd = end;
+		return true;
+	}
+
+private:
+	uintPtr m_start;
+	uintPtr m_end;
+
+	size m_commitGranularity;
+
+	uintPtr m_committedEnd;
+
+	ActualAllocator m_allocator;
+};
+
+
+template<class ActualAllocator, size CommitGranularity = 64 * 1024>
+using VirtualCommitAllocationPolicy = AllocationPolicy<VirtualCommitAllocator<ActualAllocator, CommitGranularity>, AllocationHeader>;
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -13,16 +13,16 @@
 
 #define eosAssert( condition, format, ... ) \
     if( !(condition) ) { \
-        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, __VA_ARGS__); \
+        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
     }
 #define eosAssertVoid( condition, format, ... ) \
     if( !(condition) ) { \
-        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, __VA_ARGS__); \
+        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
 		return; \
     }
 #define eosAssertValue( condition, return_value, format, ... ) \
     if( !(condition) ) { \
-        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, __VA_ARGS__); \
+        fprintf (stderr, "%s(%u): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
 		return return_value; \
     }
 
@@ -35,5 +35,5 @@
 #endif 
 
 
-#define eosAssertReturnVoid( condition, format, ... )					eosAssertVoid( condition, format, __VA_ARGS__ )
-#define eosAssertReturnValue( condition, return_value, format, ...  )	eosAssertValue( condition, return_value, format, __VA_ARGS__ )
\ No newline at end of file
+#define eosAssertReturnVoid( condition, format, ... )					eosAssertVoid( condition, format, ##__VA_ARGS__ )
+#define eosAssertReturnValue( condition, return_value, format, ...  )	eosAssertValue( condition, return_value, format, ##__VA_ARGS__ )
\ No newline at end of file
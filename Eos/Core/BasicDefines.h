@@ -5,11 +5,15 @@
 #pragma once
 
 
+#if defined(_MSC_VER)
 #ifdef EOS_EXPORTS
 #define EOS_DLL __declspec(dllexport)
 #else
 #define EOS_DLL __declspec(dllimport)
 #endif 
+#else
+#define EOS_DLL __attribute__((visibility("default")))
+#endif
 
 
 #if _WIN32 || _WIN64
@@ -35,6 +39,8 @@
 
 #define EOS_USING_NAMESPACE using namespace eos; 
 
+#if defined(_MSC_VER)
+
 #define EOS_OPTIMIZATION_OFF __pragma(optimize("",off))
 #define EOS_OPTIMIZATION_ON __pragma(optimize("",on))
 
@@ -44,3 +50,32 @@
 // tells the compiler to never inline a particular function
 #define EOS_NO_INLINE  __declspec(noinline)
 
+#else
+
+// GCC and Clang, the optimizations are chosen for the whole file
+#define EOS_OPTIMIZATION_OFF
+#define EOS_OPTIMIZATION_ON
+
+/// forces a function to be in lined
+#define EOS_INLINE inline __attribute__((always_inline))
+
+// tells the compiler to never inline a particular function
+#define EOS_NO_INLINE  __attribute__((noinline))
+
+#endif
+
+
+#if !defined(_WIN32)
+
+#include <errno.h>
+#include <stdio.h>
+
+// fopen_s is only in the Microsoft CRT, the files of the logs are opened with it
+static inline int fopen_s(FILE** _file, const char* _fileName, const char* _mode)
+{
+	*_file = fopen(_fileName, _mode);
+	return *_file != nullptr ? 0 : errno;
+}
+
+#endif
+
@@ -8,6 +8,10 @@
 #include "BasicTypes.h"
 #include "Assertions.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 
 EOS_NAMESPACE_BEGIN
 
@@ -48,6 +52,45 @@ namespace CoreUtils
 
 		return _x;
 	}
+
+	// index of the lowest bit set, _x must be different than 0
+	static EOS_INLINE uint32 FindFirstSet(uint32 _x)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, _x);
+		return static_cast<uint32>(index);
+#else
+		return static_cast<uint32>(__builtin_ctz(_x));
+#endif
+	}
+
+	// index of the highest bit set, _x must be different than 0
+	static EOS_INLINE uint32 FindLastSet(uint32 _x)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, _x);
+		return static_cast<uint32>(index);
+#else
+		return static_cast<uint32>(31 - __builtin_clz(_x));
+#endif
+	}
+
+	// index of the highest bit set, _x must be different than 0
+	static EOS_INLINE uint32 FindLastSet64(uint64 _x)
+	{
+#if defined(_MSC_VER) && defined(EOS_x64)
+		unsigned long index;
+		_BitScanReverse64(&index, _x);
+		return static_cast<uint32>(index);
+#elif defined(_MSC_VER)
+		const uint32 high = static_cast<uint32>(_x >> 32);
+		return high != 0 ? 32 + FindLastSet(high) : FindLastSet(static_cast<uint32>(_x));
+#else
+		return static_cast<uint32>(63 - __builtin_clzll(_x));
+#endif
+	}
 }
 
 
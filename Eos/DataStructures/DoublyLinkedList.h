@@ -50,6 +50,7 @@ public:
 			{
 				_prev->m_next = _add;
 				_add->m_next = nullptr;
+				_add->m_prev = _prev;
 			}
 			else 
 			{
@@ -19,7 +19,7 @@ public:
 		Node* m_next;
 	};
 
-	StackLinkedList() {}
+	StackLinkedList() : m_head(nullptr) {}
 	~StackLinkedList() {}
 
 	void Push(Node* _add)
@@ -28,10 +28,20 @@ public:
 		m_head = _add;
 	}
 
+	// the nodes from _first to _last are already linked
+	void PushRun(Node* _first, Node* _last)
+	{
+		_last->m_next = m_head;
+		m_head = _first;
+	}
+
 	Node* Pop()
 	{
 		Node* top = m_head;
-		m_head = m_head->m_next;
+		if (top != nullptr)
+		{
+			m_head = top->m_next;
+		}
 		return top;
 	}
 
@@ -40,6 +50,16 @@ public:
 		return m_head;
 	}
 
+	Node* GetHead()
+	{
+		return m_head;
+	}
+
+	void SetHead(Node* _head)
+	{
+		m_head = _head;
+	}
+
 private:
 	Node* m_head;
 };
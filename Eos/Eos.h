@@ -20,17 +20,34 @@
 #include "MemCpy.h"
 #include "MemoryHeaderPolicy.h"
 #include "MemoryThreadPolicy.h"
+#include "MemoryVirtualUtils.h"
 #include "MemoryAreaPolicy.h"
 #include "MemoryAllocationPolicy.h"
 #include "MemoryBoundsCheckPolicy.h"
 #include "MemoryLogPolicy.h"
+#include "MemoryStatsPolicy.h"
+#include "MemoryRingBufferLogPolicy.h"
+#include "MemoryProfilerPolicy.h"
+#include "MemoryTracePolicy.h"
 #include "MemoryTagPolicy.h"
 #include "MemoryAllocator.h"
+#include "ThreadCachedAllocator.h"
+#include "NumaLocalAllocator.h"
 #include "SmartPointer.h"
 
 #include "Allocators/LinearAllocator.h"
+#include "Allocators/GrowingLinearAllocator.h"
+#include "Allocators/ScopeStackAllocator.h"
+#include "Allocators/DoubleEndedStackAllocator.h"
+#include "Allocators/MultiBufferedFrameAllocator.h"
 #include "Allocators/PoolAllocator.h"
+#include "Allocators/GrowingPoolAllocator.h"
+#include "Allocators/ConcurrentPoolAllocator.h"
 #include "Allocators/FreeListAllocator.h"
+#include "Allocators/TlsfAllocator.h"
+#include "Allocators/BuddyAllocator.h"
+#include "Allocators/SmallObjectAllocator.h"
+#include "Allocators/VirtualCommitAllocator.h"
 
 #include "StlAllocator.h"
 #include "StlAllocatorsTypes.h"
@@ -25,8 +25,8 @@ namespace MemUtils
 #ifdef EOS_MEM_SIMD
 		EOS_INLINE void MemCpySIMD(void* _dst, const void* _src, size _len)
 		{
-			register uint8 *dst = (uint8*)_dst;
-			register const uint8 *src = (const uint8*)_src;
+			uint8 *dst = (uint8*)_dst;
+			const uint8 *src = (const uint8*)_src;
 
 			size i = 0;
 			for (; i + 128 <= _len; i += 128)
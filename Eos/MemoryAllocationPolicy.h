@@ -4,12 +4,79 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "MemoryHeaderPolicy.h"
+#include "MemoryLayoutUtils.h"
 
 
 EOS_NAMESPACE_BEGIN
 
 
+// Used by the allocators with more than one stack end, for instance the DoubleEndedStackAllocator
+enum EStackEnd
+{
+	EStackEnd_Bottom,
+	EStackEnd_Top
+};
+
+
+namespace MemUtils
+{
+	// true for the allocators able to resize an allocation without moving it, having TryExpandInPlace and ShrinkInPlace
+	template <typename T, typename = void>
+	struct HasInPlaceResize
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct HasInPlaceResize<T, decltype((void)&T::TryExpandInPlace, (void)&T::ShrinkInPlace)>
+	{
+		static const bool value = true;
+	};
+
+	// true for the allocators with their own AllocateBatch and FreeBatch
+	template <typename T, typename = void>
+	struct HasBatch
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct HasBatch<T, decltype((void)&T::AllocateBatch, (void)&T::FreeBatch)>
+	{
+		static const bool value = true;
+	};
+
+	// true for the allocators keeping track of the allocations released by a rewind, having PopAllocation
+	template <typename T, typename = void>
+	struct HasPopAllocation
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct HasPopAllocation<T, decltype((void)&T::PopAllocation)>
+	{
+		static const bool value = true;
+	};
+
+	// true for the allocators finding the block from the size and the alignment of the allocation, having FreeSized
+	template <typename T, typename = void>
+	struct HasSizedFree
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct HasSizedFree<T, decltype((void)&T::FreeSized)>
+	{
+		static const bool value = true;
+	};
+}
+
+
 template<typename ActualAllocator, class HeaderPolicy>
 class AllocationPolicy
 {
@@ -21,6 +88,12 @@ public:
 	{
 	}
 
+	// Only for the allocators with a State, restored from it when not null
+	template<typename State>
+	AllocationPolicy(void* _start, void* _end, size _headerSize, size _footerSize, const State* _state) : m_allocator(_start, _end, _headerSize, _footerSize, _state)
+	{
+	}
+
 	EOS_INLINE void StoreSize(void* _ptr, size _size)
 	{
 		m_header.StoreSize(_ptr, _size);
@@ -46,6 +119,101 @@ public:
 		m_allocator.Free(_ptr, _size);
 	}
 
+	// The size, the alignment and the header size are the ones given to Allocate
+	EOS_INLINE void Free(void* _ptr, size _size, size _alignment, size _headerSize)
+	{
+		Free(_ptr, _size, _alignment, _headerSize, MemUtils::IntToType<MemUtils::HasSizedFree<ActualAllocator>::value>());
+	}
+
+	// The sizes are the full ones, as given to Allocate. When the allocator cannot resize in place, they return false
+	// and the caller has to move the allocation.
+	EOS_INLINE bool TryExpandInPlace(void* _ptr, size _oldSize, size _newSize)
+	{
+		return TryExpandInPlace(_ptr, _oldSize, _newSize, MemUtils::IntToType<MemUtils::HasInPlaceResize<ActualAllocator>::value>());
+	}
+
+	EOS_INLINE bool ShrinkInPlace(void* _ptr, size _oldSize, size _newSize)
+	{
+		return ShrinkInPlace(_ptr, _oldSize, _newSize, MemUtils::IntToType<MemUtils::HasInPlaceResize<ActualAllocator>::value>());
+	}
+
+	// Allocates up to _count blocks of the same size, returns how many are in _out, less than _count when the memory is over
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, size _headerSize, size _footerSize, void** _out)
+	{
+		return AllocateBatch(_count, _size, _alignment, _headerSize, _footerSize, _out, MemUtils::IntToType<MemUtils::HasBatch<ActualAllocator>::value>());
+	}
+
+	// The pointers are the ones given to the user, _offset bytes after the blocks of the allocator
+	EOS_INLINE void FreeBatch(void* const* _ptrs, size _count, size _offset)
+	{
+		FreeBatch(_ptrs, _count, _offset, MemUtils::IntToType<MemUtils::HasBatch<ActualAllocator>::value>());
+	}
+
+	EOS_INLINE void Reset()
+	{
+		m_allocator.Reset();
+	}
+
+	EOS_INLINE uintPtr GetMarker() const
+	{
+		return m_allocator.GetMarker();
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		m_allocator.RewindTo(_marker);
+	}
+
+	// The visitor is called with each allocation released, the most recent first, when the allocator keeps track of them
+	template<typename Visitor>
+	EOS_INLINE void RewindTo(uintPtr _marker, Visitor&& _visitor)
+	{
+		RewindTo(_marker, _visitor, MemUtils::IntToType<MemUtils::HasPopAllocation<ActualAllocator>::value>());
+	}
+
+	EOS_INLINE void* Allocate(EStackEnd _end, size _size, size _alignment, size _headerSize, size _footerSize)
+	{
+		return m_allocator.Allocate(_end, _size, _alignment, _headerSize, _footerSize);
+	}
+
+	EOS_INLINE uintPtr GetMarker(EStackEnd _end) const
+	{
+		return m_allocator.GetMarker(_end);
+	}
+
+	EOS_INLINE void RewindTo(EStackEnd _end, uintPtr _marker)
+	{
+		m_allocator.RewindTo(_end, _marker);
+	}
+
+	EOS_INLINE void AdvanceFrame()
+	{
+		m_allocator.AdvanceFrame();
+	}
+
+	EOS_INLINE uint32 GetFrameIndex() const
+	{
+		return m_allocator.GetFrameIndex();
+	}
+
+	template<typename State>
+	EOS_INLINE void GetState(State& _state) const
+	{
+		m_allocator.GetState(_state);
+	}
+
+	template<typename Visitor>
+	EOS_INLINE void WalkHeap(Visitor&& _visitor) const
+	{
+		m_allocator.WalkHeap(_visitor);
+	}
+
+	template<typename Report>
+	EOS_INLINE void GetFragmentationReport(Report& _report) const
+	{
+		m_allocator.GetFragmentationReport(_report);
+	}
+
 	EOS_INLINE size GetUsedMemory()  const
 	{
 		return m_allocator.GetUsedMemory();
@@ -56,6 +224,87 @@ public:
 		return m_allocator.GetTotalMemory();
 	}
 
+private:
+	EOS_INLINE void Free(void* _ptr, size _size, size _alignment, size _headerSize, MemUtils::IntToType<true>)
+	{
+		m_allocator.FreeSized(_ptr, _size, _alignment, _headerSize);
+	}
+
+	EOS_INLINE void Free(void* _ptr, size _size, size, size, MemUtils::IntToType<false>)
+	{
+		m_allocator.Free(_ptr, _size);
+	}
+
+	template<typename Visitor>
+	EOS_INLINE void RewindTo(uintPtr _marker, Visitor& _visitor, MemUtils::IntToType<true>)
+	{
+		for (void* ptr = m_allocator.PopAllocation(_marker); ptr != nullptr; ptr = m_allocator.PopAllocation(_marker))
+		{
+			_visitor(ptr);
+		}
+
+		m_allocator.RewindTo(_marker);
+	}
+
+	template<typename Visitor>
+	EOS_INLINE void RewindTo(uintPtr _marker, Visitor&, MemUtils::IntToType<false>)
+	{
+		m_allocator.RewindTo(_marker);
+	}
+
+	EOS_INLINE bool TryExpandInPlace(void* _ptr, size _oldSize, size _newSize, MemUtils::IntToType<true>)
+	{
+		return m_allocator.TryExpandInPlace(_ptr, _oldSize, _newSize);
+	}
+
+	EOS_INLINE bool TryExpandInPlace(void*, size, size, MemUtils::IntToType<false>)
+	{
+		return false;
+	}
+
+	EOS_INLINE bool ShrinkInPlace(void* _ptr, size _oldSize, size _newSize, MemUtils::IntToType<true>)
+	{
+		return m_allocator.ShrinkInPlace(_ptr, _oldSize, _newSize);
+	}
+
+	EOS_INLINE bool ShrinkInPlace(void*, size, size, MemUtils::IntToType<false>)
+	{
+		return false;
+	}
+
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, size _headerSize, size _footerSize, void** _out, MemUtils::IntToType<true>)
+	{
+		return m_allocator.AllocateBatch(_count, _size, _alignment, _headerSize, _footerSize, _out);
+	}
+
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, size _headerSize, size _footerSize, void** _out, MemUtils::IntToType<false>)
+	{
+		size i = 0;
+		for (; i < _count; ++i)
+		{
+			_out[i] = m_allocator.Allocate(_size, _alignment, _headerSize, _footerSize);
+			if (_out[i] == nullptr)
+			{
+				break;
+			}
+		}
+		return i;
+	}
+
+	EOS_INLINE void FreeBatch(void* const* _ptrs, size _count, size _offset, MemUtils::IntToType<true>)
+	{
+		m_allocator.FreeBatch(_ptrs, _count, _offset);
+	}
+
+	EOS_INLINE void FreeBatch(void* const* _ptrs, size _count, size _offset, MemUtils::IntToType<false>)
+	{
+		for (size i = 0; i < _count; ++i)
+		{
+			uint8* buffer = static_cast<uint8*>(_ptrs[i]) - _offset;
+			m_allocator.Free(buffer, m_header.GetSize(buffer));
+		}
+	}
+
 private:
 	ActualAllocator m_allocator;
 	HeaderPolicy m_header;
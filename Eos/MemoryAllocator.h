@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <string>
+
 #include "Core/NoCopyable.h"
+#include "Core/PointerUtils.h"
 #include "MemCpy.h"
 
 EOS_NAMESPACE_BEGIN
@@ -27,6 +30,21 @@ public:
 		, m_debugInspectorName(_name)
 #endif
 	{
+		MemUtils::SetAllocationOverhead(m_memoryLog, m_headerSize + BoundsCheckPolicy::kSizeBack);
+	}
+
+	// Only for the allocators with a State, for instance the LinearAllocator and the FreeListAllocator.
+	// When the state is not null the allocator continues from it, with the memory of the area as it is, see the MappedFileArea.
+	template<typename AreaPolicy, typename State>
+	MemoryAllocator(const AreaPolicy& _area, const char* _name, const State* _state) :
+		m_headerSize(AllocationPolicy::kHeaderSize + BoundsCheckPolicy::kSizeFront),
+		m_allocator(_area.GetStart(), _area.GetEnd(), m_headerSize, BoundsCheckPolicy::kSizeBack, _state),
+		m_memoryLog(_name)
+#ifdef _DEBUG
+		, m_debugInspectorName(_name)
+#endif
+	{
+		MemUtils::SetAllocationOverhead(m_memoryLog, m_headerSize + BoundsCheckPolicy::kSizeBack);
 	}
 
 	~MemoryAllocator()
@@ -35,45 +53,98 @@ public:
 	}
 
 	EOS_INLINE void* Allocate(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		m_thread.Enter();
+		void* ptr = AllocateUnlocked(_size, _alignment, _sourceInfo);
+		m_thread.Leave();
+		return ptr;
+	}
+
+	EOS_INLINE void Free(void* _ptr)
+	{
+		m_thread.Enter();
+		FreeUnlocked(_ptr);
+		m_thread.Leave();
+	}
+
+	// Sized free: the size and the alignment must be the ones given to Allocate, so nothing is read back from the memory
+	// and the allocators able to find the block from them do not need any header for it
+	EOS_INLINE void Free(void* _ptr, size _size, size _alignment)
+	{
+		m_thread.Enter();
+		FreeUnlocked(_ptr, _size + m_headerSize + BoundsCheckPolicy::kSizeBack, _alignment);
+		m_thread.Leave();
+	}
+
+	// Allocates _count blocks of the same size under a single lock, returns how many are in _out,
+	// less than _count when the memory is over
+	EOS_INLINE size AllocateBatch(size _count, size _size, size _alignment, void** _out, const LogSourceInfo& _sourceInfo)
 	{
 		m_thread.Enter();
 
 		const size totalSize = _size + m_headerSize + BoundsCheckPolicy::kSizeBack;
 
-		uint8* buffer = static_cast<uint8*>(m_allocator.Allocate(totalSize, _alignment, m_headerSize, BoundsCheckPolicy::kSizeBack));
+		const size allocated = m_allocator.AllocateBatch(_count, totalSize, _alignment, m_headerSize, BoundsCheckPolicy::kSizeBack, _out);
+		for (size i = 0; i < allocated; ++i)
+		{
+			uint8* buffer = static_cast<uint8*>(_out[i]);
+
+			m_allocator.StoreSize(buffer, totalSize);
 
-		m_allocator.StoreSize(buffer, totalSize);
+			m_boundsChecker.GuardFront(buffer + AllocationPolicy::kHeaderSize);
+			m_memoryTag.TagAllocation(buffer + m_headerSize, _size);
+			m_boundsChecker.GuardBack(buffer + m_headerSize + _size);
 
-		m_boundsChecker.GuardFront(buffer + AllocationPolicy::kHeaderSize);
-		m_memoryTag.TagAllocation(buffer + m_headerSize, _size);
-		m_boundsChecker.GuardBack(buffer + m_headerSize + _size);
+			m_memoryLog.OnAllocation(buffer, totalSize, _alignment, _sourceInfo);
 
-		m_memoryLog.OnAllocation(buffer, totalSize, _alignment, _sourceInfo);
+			_out[i] = buffer + m_headerSize;
+		}
+
+		for (size i = allocated; i < _count; ++i)
+		{
+			m_memoryLog.OnAllocationFailure(totalSize, _alignment, _sourceInfo);
+		}
 
 		m_thread.Leave();
 
-		return (buffer + m_headerSize);
+		return allocated;
 	}
 
-	EOS_INLINE void Free(void* _ptr)
+	// Frees _count pointers under a single lock, the null ones are skipped
+	EOS_INLINE void FreeBatch(void* const* _ptrs, size _count)
 	{
 		m_thread.Enter();
 
-		uint8* buffer = static_cast<uint8*>(_ptr) - m_headerSize;
-		const size totalSize = m_allocator.GetSize(buffer);
-		const size allocationSize = totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
-
-		m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
-		m_memoryTag.TagDeallocation(buffer + m_headerSize, allocationSize);
-		m_boundsChecker.CheckFront(buffer + AllocationPolicy::kHeaderSize);
-
-		m_memoryLog.OnDeallocation(buffer, totalSize);
-
-		m_allocator.Free(buffer, totalSize);
+		size first = 0;
+		for (size i = 0; i <= _count; ++i)
+		{
+			// the runs between the null pointers are given to the allocator at once
+			if (i == _count || _ptrs[i] == nullptr)
+			{
+				if (i > first)
+				{
+					m_allocator.FreeBatch(_ptrs + first, i - first, m_headerSize);
+				}
+				first = i + 1;
+				continue;
+			}
+
+			uint8* buffer = static_cast<uint8*>(_ptrs[i]) - m_headerSize;
+			const size totalSize = m_allocator.GetSize(buffer);
+			const size allocationSize = totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
+
+			m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
+			m_memoryTag.TagDeallocation(buffer + m_headerSize, allocationSize);
+			m_boundsChecker.CheckFront(buffer + AllocationPolicy::kHeaderSize);
+
+			m_memoryLog.OnDeallocation(buffer, totalSize);
+		}
 
 		m_thread.Leave();
 	}
 
+	// Resizes in place when the allocator can (see TryExpandInPlace and ShrinkInPlace) and the alignment is kept,
+	// otherwise it moves the allocation. All under a single lock.
 	EOS_INLINE void* Reallocate(void* _ptr, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
 	{
 		if (_ptr == nullptr)
@@ -82,19 +153,49 @@ public:
 		}
 
 		m_thread.Enter();
- 		uint8* buffer = static_cast<uint8*>(_ptr) - m_headerSize;
- 		const size totalSize = m_allocator.GetAllocatedSize(buffer);
- 		const size allocationSize = totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
- 		const size sizeToCopy = allocationSize > _size ? _size : allocationSize;
-		m_thread.Leave();
 
-		void* newPtr = Allocate(_size, _alignment, _sourceInfo);
+		uint8* buffer = static_cast<uint8*>(_ptr) - m_headerSize;
+		const size overheadSize = m_headerSize + BoundsCheckPolicy::kSizeBack;
+
+		// without the size in the header, the allocator gives the size it knows, which for some can be bigger than the allocation
+		const size totalSize = AllocationPolicy::kHeaderSize > 0 ? m_allocator.GetSize(buffer) : m_allocator.GetAllocatedSize(buffer);
+		const size allocationSize = totalSize > overheadSize ? totalSize - overheadSize : 0;
+		const size newTotalSize = _size + overheadSize;
 
-		m_thread.Enter();
-		MemUtils::MemCpy(newPtr, _ptr, sizeToCopy);
-		m_thread.Leave();
+		if (CoreUtils::AlignTop((uintPtr)_ptr, _alignment) == (uintPtr)_ptr)
+		{
+			// checked before, shrinking gives the memory of the back guard to the allocator
+			m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
+
+			const bool resized = newTotalSize > totalSize ? m_allocator.TryExpandInPlace(buffer, totalSize, newTotalSize) : m_allocator.ShrinkInPlace(buffer, totalSize, newTotalSize);
+			if (resized)
+			{
+				if (_size > allocationSize)
+				{
+					m_memoryTag.TagAllocation(buffer + m_headerSize + allocationSize, _size - allocationSize);
+				}
+				m_allocator.StoreSize(buffer, newTotalSize);
+				m_boundsChecker.GuardBack(buffer + m_headerSize + _size);
+
+				m_memoryLog.OnDeallocation(buffer, totalSize);
+				m_memoryLog.OnAllocation(buffer, newTotalSize, _alignment, _sourceInfo);
+
+				m_thread.Leave();
+
+				return _ptr;
+			}
+		}
+
+		void* newPtr = AllocateUnlocked(_size, _alignment, _sourceInfo);
+		if (newPtr != nullptr)
+		{
+			const size sizeToCopy = allocationSize > _size ? _size : allocationSize;
+			MemUtils::MemCpy(newPtr, _ptr, sizeToCopy);
+
+			FreeUnlocked(_ptr);
+		}
 
-		Free(_ptr);
+		m_thread.Leave();
 
 		return newPtr;
 	}
@@ -107,11 +208,201 @@ public:
 		m_thread.Leave();
 	}
 
+	// Only for the LogPolicy with a snapshot, for instance the MemoryStats. It is taken without the lock.
+	template<typename Snapshot>
+	EOS_INLINE void GetSnapshot(Snapshot& _snapshot) const
+	{
+		m_memoryLog.GetSnapshot(_snapshot);
+	}
+
+	// Only for the LogPolicy with a heap profile, for instance the MemoryHeapProfiler. It is taken without the lock.
+	EOS_INLINE void WriteHeapProfile(std::string& _out) const
+	{
+		m_memoryLog.WriteHeapProfile(_out);
+	}
+
+	EOS_INLINE bool WriteHeapProfile(const char* _fileName) const
+	{
+		return m_memoryLog.WriteHeapProfile(_fileName);
+	}
+
+	EOS_INLINE void WriteSourceProfile(std::string& _out) const
+	{
+		m_memoryLog.WriteSourceProfile(_out);
+	}
+
+	// Only for the allocators supporting the markers, for instance the LinearAllocator and the ScopeStackAllocator.
+	// Rewinding releases all the allocations made after the marker was taken, without calling any Free.
+	// The allocators keeping track of them, as the ScopeStackAllocator, give them back to be checked and logged as freed.
+	EOS_INLINE uintPtr GetMarker()
+	{
+		m_thread.Enter();
+		const uintPtr marker = m_allocator.GetMarker();
+		m_thread.Leave();
+		return marker;
+	}
+
+	EOS_INLINE void RewindTo(uintPtr _marker)
+	{
+		m_thread.Enter();
+		m_allocator.RewindTo(_marker, [this](void* _buffer) { ReleaseUnlocked(_buffer); });
+		m_thread.Leave();
+	}
+
+	// Only for the allocators with a State, the logged allocations are not part of it
+	template<typename State>
+	EOS_INLINE void GetState(State& _state)
+	{
+		m_thread.Enter();
+		m_allocator.GetState(_state);
+		m_thread.Leave();
+	}
+
+	// Only for the allocators with a heap walk, for instance the FreeListAllocator.
+	// The visitor is called with each block under the lock, held for all the walk, so it must not use this allocator.
+	// The memory of a block starts with the header of the allocator, before the memory given by Allocate.
+	template<typename Visitor>
+	EOS_INLINE void WalkHeap(Visitor&& _visitor)
+	{
+		m_thread.Enter();
+		m_allocator.WalkHeap(_visitor);
+		m_thread.Leave();
+	}
+
+	// Walks all the heap under the lock, for instance from a thread watching the fragmentation
+	template<typename Report>
+	EOS_INLINE void GetFragmentationReport(Report& _report)
+	{
+		m_thread.Enter();
+		m_allocator.GetFragmentationReport(_report);
+		m_thread.Leave();
+	}
+
+	// Only for the allocators with more than one stack end, for instance the DoubleEndedStackAllocator.
+	// The end is given to each call and is not kept in the allocator, so the threads can use different ends, see the StackEndAllocator.
+	EOS_INLINE void* Allocate(EStackEnd _end, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		m_thread.Enter();
+		void* ptr = AllocateUnlocked(_end, _size, _alignment, _sourceInfo);
+		m_thread.Leave();
+		return ptr;
+	}
+
+	EOS_INLINE uintPtr GetMarker(EStackEnd _end)
+	{
+		m_thread.Enter();
+		const uintPtr marker = m_allocator.GetMarker(_end);
+		m_thread.Leave();
+		return marker;
+	}
+
+	EOS_INLINE void RewindTo(EStackEnd _end, uintPtr _marker)
+	{
+		m_thread.Enter();
+		m_allocator.RewindTo(_end, _marker);
+		m_thread.Leave();
+	}
+
+	// Only for the frame allocators, for instance the MultiBufferedFrameAllocator.
+	// Releases the allocations of the oldest frame, nobody must be allocating meanwhile.
+	EOS_INLINE void AdvanceFrame()
+	{
+		m_thread.Enter();
+		m_allocator.AdvanceFrame();
+		m_thread.Leave();
+	}
+
+	EOS_INLINE uint32 GetFrameIndex() const { return m_allocator.GetFrameIndex(); }
+
 	EOS_INLINE size GetUsedMemory() const { return m_allocator.GetUsedMemory(); }
 	EOS_INLINE size GetTotalMemory() const { return m_allocator.GetTotalMemory(); }
 	EOS_INLINE size GetNumAllocations() const { return m_memoryLog.GetNumAllocations(); }
 	EOS_INLINE size GetAllocatedSize() const { return m_memoryLog.GetAllocatedSize(); }
 
+private:
+	EOS_INLINE void* AllocateUnlocked(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		const size totalSize = _size + m_headerSize + BoundsCheckPolicy::kSizeBack;
+
+		void* buffer = m_allocator.Allocate(totalSize, _alignment, m_headerSize, BoundsCheckPolicy::kSizeBack);
+		return OnAllocated(static_cast<uint8*>(buffer), _size, _alignment, _sourceInfo);
+	}
+
+	EOS_INLINE void* AllocateUnlocked(EStackEnd _end, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		const size totalSize = _size + m_headerSize + BoundsCheckPolicy::kSizeBack;
+
+		void* buffer = m_allocator.Allocate(_end, totalSize, _alignment, m_headerSize, BoundsCheckPolicy::kSizeBack);
+		return OnAllocated(static_cast<uint8*>(buffer), _size, _alignment, _sourceInfo);
+	}
+
+	// guards, tags and logs the buffer given by the allocator, returns the memory for the user
+	EOS_INLINE void* OnAllocated(uint8* _buffer, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		const size totalSize = _size + m_headerSize + BoundsCheckPolicy::kSizeBack;
+
+		if (_buffer == nullptr)
+		{
+			m_memoryLog.OnAllocationFailure(totalSize, _alignment, _sourceInfo);
+			return nullptr;
+		}
+
+		m_allocator.StoreSize(_buffer, totalSize);
+
+		m_boundsChecker.GuardFront(_buffer + AllocationPolicy::kHeaderSize);
+		m_memoryTag.TagAllocation(_buffer + m_headerSize, _size);
+		m_boundsChecker.GuardBack(_buffer + m_headerSize + _size);
+
+		m_memoryLog.OnAllocation(_buffer, totalSize, _alignment, _sourceInfo);
+
+		return (_buffer + m_headerSize);
+	}
+
+	// for the allocations released without Free, the memory is already given back
+	EOS_INLINE void ReleaseUnlocked(void* _buffer)
+	{
+		uint8* buffer = static_cast<uint8*>(_buffer);
+		const size totalSize = m_allocator.GetSize(buffer);
+		const size allocationSize = totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
+
+		m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
+		m_memoryTag.TagDeallocation(buffer + m_headerSize, allocationSize);
+		m_boundsChecker.CheckFront(buffer + AllocationPolicy::kHeaderSize);
+
+		m_memoryLog.OnDeallocation(buffer, totalSize);
+	}
+
+	EOS_INLINE void FreeUnlocked(void* _ptr)
+	{
+		uint8* buffer = static_cast<uint8*>(_ptr) - m_headerSize;
+		const size totalSize = m_allocator.GetSize(buffer);
+		const size allocationSize = totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
+
+		m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
+		m_memoryTag.TagDeallocation(buffer + m_headerSize, allocationSize);
+		m_boundsChecker.CheckFront(buffer + AllocationPolicy::kHeaderSize);
+
+		m_memoryLog.OnDeallocation(buffer, totalSize);
+
+		m_allocator.Free(buffer, totalSize);
+	}
+
+	EOS_INLINE void FreeUnlocked(void* _ptr, size _totalSize, size _alignment)
+	{
+		uint8* buffer = static_cast<uint8*>(_ptr) - m_headerSize;
+		const size allocationSize = _totalSize - (m_headerSize + BoundsCheckPolicy::kSizeBack);
+
+		eosAssert(AllocationPolicy::kHeaderSize == 0 || m_allocator.GetSize(buffer) == _totalSize, "The size given to Free is not the one of the allocation");
+
+		m_boundsChecker.CheckBack(buffer + m_headerSize + allocationSize);
+		m_memoryTag.TagDeallocation(buffer + m_headerSize, allocationSize);
+		m_boundsChecker.CheckFront(buffer + AllocationPolicy::kHeaderSize);
+
+		m_memoryLog.OnDeallocation(buffer, _totalSize);
+
+		m_allocator.Free(buffer, _totalSize, _alignment, m_headerSize);
+	}
+
 private:
 	const size m_headerSize;
 
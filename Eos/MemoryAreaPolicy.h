@@ -5,7 +5,11 @@
 #pragma once
 
 #include <memory>
+#include <cstring>
 #include "Core/NoCopyable.h"
+#include "Core/Assertions.h"
+#include "Core/PointerUtils.h"
+#include "MemoryVirtualUtils.h"
 
 
 EOS_NAMESPACE_BEGIN
@@ -75,5 +79,323 @@ private:
 };
 
 
+// Area aligned to the huge page size (2 MB), backed by the huge pages when the system allows it, see GetBacking.
+// The size is rounded up to the huge page size.
+template<size Size>
+class HugePageArea : public NoCopyableMoveable
+{
+public:
+	HugePageArea() : m_size(Size)
+	{
+		m_start = MemUtils::AllocateHugePageMemory(m_size, m_backing);
+
+		eosAssert(m_start != nullptr, "Cannot allocate the huge page memory");
+
+		m_end = m_start != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_start) + m_size) : nullptr;
+	}
+
+	~HugePageArea()
+	{
+		if (m_start != nullptr)
+		{
+			MemUtils::FreeHugePageMemory(m_start, m_size);
+		}
+	}
+
+	EOS_INLINE void* GetStart() const { return m_start; }
+	EOS_INLINE void* GetEnd() const { return m_end; }
+	EOS_INLINE EHugePageBacking GetBacking() const { return m_backing; }
+
+private:
+	void* m_start;
+	void* m_end;
+	size m_size;
+	EHugePageBacking m_backing;
+};
+
+// R is for "runtime" to distinguished against the normal template version
+class HugePageAreaR : public NoCopyableMoveable
+{
+public:
+	HugePageAreaR(size _size) : m_size(_size)
+	{
+		m_start = MemUtils::AllocateHugePageMemory(m_size, m_backing);
+
+		eosAssert(m_start != nullptr, "Cannot allocate the huge page memory");
+
+		m_end = m_start != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_start) + m_size) : nullptr;
+	}
+
+	~HugePageAreaR()
+	{
+		if (m_start != nullptr)
+		{
+			MemUtils::FreeHugePageMemory(m_start, m_size);
+		}
+	}
+
+	EOS_INLINE void* GetStart() const { return m_start; }
+	EOS_INLINE void* GetEnd() const { return m_end; }
+	EOS_INLINE EHugePageBacking GetBacking() const { return m_backing; }
+
+private:
+	void* m_start;
+	void* m_end;
+	size m_size;
+	EHugePageBacking m_backing;
+};
+
+
+// Area with the physical memory taken from one NUMA node, instead of the node of the thread touching it first.
+// When the system has only one node, or the memory cannot be bound, it is normal memory, see IsBound.
+class NumaArea : public NoCopyableMoveable
+{
+public:
+	NumaArea(size _size, uint32 _node) : m_size(_size), m_node(_node)
+	{
+		m_start = MemUtils::AllocateNumaMemory(m_size, m_node, m_bound);
+
+		eosAssert(m_start != nullptr, "Cannot allocate the NUMA memory");
+
+		m_end = m_start != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_start) + m_size) : nullptr;
+	}
+
+	~NumaArea()
+	{
+		if (m_start != nullptr)
+		{
+			MemUtils::FreeNumaMemory(m_start, m_size);
+		}
+	}
+
+	EOS_INLINE void* GetStart() const { return m_start; }
+	EOS_INLINE void* GetEnd() const { return m_end; }
+	EOS_INLINE uint32 GetNode() const { return m_node; }
+	EOS_INLINE bool IsBound() const { return m_bound; }
+
+private:
+	void* m_start;
+	void* m_end;
+	size m_size;
+	uint32 m_node;
+	bool m_bound;
+};
+
+
+// Only the address range is reserved at construction time, the memory is committed when needed.
+// The allocators use it through the VirtualCommitAllocator, or the memory can be committed and decommitted manually.
+// The VirtualCommitAllocator commits and decommits the pages itself, so the area does not know them: Commit always commits
+// from the start, and the memory of an allocator on the area must not be decommitted by hand.
+// The size is rounded up to the page size.
+class VirtualArea : public NoCopyableMoveable
+{
+public:
+	VirtualArea(size _reserveSize, size _commitSize = 0)
+	{
+		m_pageSize = MemUtils::GetVirtualPageSize();
+
+		const size reserveSize = CoreUtils::AlignTop(_reserveSize, m_pageSize);
+		m_start = MemUtils::ReserveVirtualMemory(reserveSize);
+
+		eosAssert(m_start != nullptr, "Cannot reserve the virtual memory");
+
+		m_end = m_start != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_start) + reserveSize) : nullptr;
+		m_committedEnd = reinterpret_cast<uintPtr>(m_start);
+
+		if (_commitSize > 0)
+		{
+			Commit(reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_start) + _commitSize));
+		}
+	}
+
+	~VirtualArea()
+	{
+		if (m_start != nullptr)
+		{
+			MemUtils::ReleaseVirtualMemory(m_start, reinterpret_cast<uintPtr>(m_end) - reinterpret_cast<uintPtr>(m_start));
+		}
+	}
+
+	EOS_INLINE void* GetStart() const { return m_start; }
+	EOS_INLINE void* GetEnd() const { return m_end; }
+
+	// commits the memory from the start up to the page containing _end, also the pages already committed,
+	// since a VirtualCommitAllocator can have decommitted them meanwhile
+	EOS_INLINE bool Commit(void* _end)
+	{
+		const uintPtr start = reinterpret_cast<uintPtr>(m_start);
+		const uintPtr end = CoreUtils::AlignTop(reinterpret_cast<uintPtr>(_end), m_pageSize);
+
+		eosAssertReturnValue(end <= reinterpret_cast<uintPtr>(m_end), false, "Cannot commit outside the area");
+
+		if (end > start && !MemUtils::CommitVirtualMemory(m_start, end - start))
+		{
+			return false;
+		}
+
+		m_committedEnd = end > m_committedEnd ? end : m_committedEnd;
+		return true;
+	}
+
+	// decommits the memory from the page after _end, the memory before is still committed
+	EOS_INLINE void Decommit(void* _end)
+	{
+		const uintPtr end = CoreUtils::AlignTop(reinterpret_cast<uintPtr>(_end), m_pageSize);
+		if (end < m_committedEnd)
+		{
+			MemUtils::DecommitVirtualMemory(reinterpret_cast<void*>(end), m_committedEnd - end);
+			m_committedEnd = end;
+		}
+	}
+
+	// only the memory committed by hand, see GetCommittedMemory of the VirtualCommitAllocator for the one of the allocator
+	EOS_INLINE size GetCommittedSize() const { return m_committedEnd - reinterpret_cast<uintPtr>(m_start); }
+	EOS_INLINE size GetPageSize() const { return m_pageSize; }
+
+private:
+	void* m_start;
+	void* m_end;
+	uintPtr m_committedEnd;
+	size m_pageSize;
+};
+
+
+// Area on a file mapped in memory, so what is allocated in it persists between runs of the process.
+// The file begins with a header page recording the address where it is mapped, the size and a snapshot of the allocator state.
+// When the file exists it is mapped again at the recorded address, and IsRestored tells if that succeeded;
+// then the allocator is constructed with the state from LoadState, and all the pointers inside the area are still valid.
+// When an existing file cannot be mapped again the area is not mapped (see IsMapped) and the file is left as it is,
+// unless _overwrite is true, then the file becomes a new area.
+// A new file is mapped at _baseAddress, or anywhere when it is null.
+class MappedFileArea : public NoCopyableMoveable
+{
+private:
+	static constexpr uint64 kMagic = 0x41455241534F45ull;	// "EOSAREA"
+	static constexpr size kHeaderSize = 4096;
+	static constexpr size kMaxStateSize = 256;
+
+	struct Header
+	{
+		uint64 m_magic;
+		uint64 m_baseAddress;
+		uint64 m_size;
+		uint64 m_stateSize;
+		uint8 m_state[kMaxStateSize];
+	};
+
+	static_assert(sizeof(Header) <= kHeaderSize, "Header does not fit in the header page");
+
+public:
+	MappedFileArea(const char* _path, size _size, void* _baseAddress = nullptr, bool _overwrite = false) : m_restored(false)
+	{
+		m_mapping.m_address = nullptr;
+
+		const size fileSize = MemUtils::GetFileSize(_path);
+		if (fileSize >= kHeaderSize)
+		{
+			// look at the header first, to know where the file was mapped
+			MemUtils::FileMapping headerMapping;
+			if (MemUtils::MapFile(_path, kHeaderSize, nullptr, headerMapping))
+			{
+				const Header header = *static_cast<const Header*>(headerMapping.m_address);
+				MemUtils::UnmapFile(headerMapping);
+
+				if (header.m_magic == kMagic && header.m_baseAddress != 0)
+				{
+					m_restored = MemUtils::MapFile(_path, kHeaderSize + static_cast<size>(header.m_size), (void*)static_cast<uintPtr>(header.m_baseAddress), m_mapping);
+				}
+			}
+		}
+
+		// the data in the file is not lost because the address is taken this time
+		if (!m_restored && fileSize > 0 && !_overwrite)
+		{
+			return;
+		}
+
+		if (!m_restored)
+		{
+			const bool mapped = MemUtils::MapFile(_path, kHeaderSize + _size, _baseAddress, m_mapping);
+
+			eosAssert(mapped, "Cannot map the file");
+
+			if (mapped)
+			{
+				Header* header = GetHeader();
+				header->m_magic = kMagic;
+				header->m_baseAddress = static_cast<uint64>((uintPtr)m_mapping.m_address);
+				header->m_size = static_cast<uint64>(_size);
+				header->m_stateSize = 0;
+			}
+		}
+	}
+
+	~MappedFileArea()
+	{
+		MemUtils::UnmapFile(m_mapping);
+	}
+
+	EOS_INLINE void* GetStart() const { return m_mapping.m_address != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_mapping.m_address) + kHeaderSize) : nullptr; }
+	EOS_INLINE void* GetEnd() const { return m_mapping.m_address != nullptr ? reinterpret_cast<void*>(reinterpret_cast<uintPtr>(m_mapping.m_address) + m_mapping.m_size) : nullptr; }
+	EOS_INLINE bool IsMapped() const { return m_mapping.m_address != nullptr; }
+	EOS_INLINE bool IsRestored() const { return m_restored; }
+
+	// the state is the one of the allocator using the area, taken with its GetState
+	template<typename State>
+	EOS_INLINE void SaveState(const State& _state)
+	{
+		static_assert(sizeof(State) <= kMaxStateSize, "State is too big to be stored in the header");
+
+		Header* header = GetHeader();
+		memcpy(header->m_state, &_state, sizeof(State));
+		header->m_stateSize = sizeof(State);
+	}
+
+	// false if the area is new or the state saved is not of this type
+	template<typename State>
+	EOS_INLINE bool LoadState(State& _state) const
+	{
+		const Header* header = GetHeader();
+		if (!m_restored || header->m_stateSize != sizeof(State))
+		{
+			return false;
+		}
+
+		memcpy(&_state, header->m_state, sizeof(State));
+		return true;
+	}
+
+	// writes the memory to the file, after it the file is a snapshot which can be restored
+	EOS_INLINE void Flush()
+	{
+		MemUtils::FlushFile(m_mapping);
+	}
+
+private:
+	EOS_INLINE Header* GetHeader() const { return static_cast<Header*>(m_mapping.m_address); }
+
+private:
+	MemUtils::FileMapping m_mapping;
+	bool m_restored;
+};
+
+
+// Gives the extra chunks to the growing allocators, from the heap.
+// Any class with the same 2 static functions can be used instead, for instance to take the chunks from a parent area.
+class HeapChunkSource
+{
+public:
+	static EOS_INLINE void* AllocateChunk(size _size)
+	{
+		return malloc(_size);
+	}
+
+	static EOS_INLINE void FreeChunk(void* _ptr, size /*_size*/)
+	{
+		free(_ptr);
+	}
+};
+
+
 
 EOS_NAMESPACE_END
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "Core/BasicTypes.h"
 
 #include "MemoryLayoutUtils.h"
@@ -13,6 +15,7 @@
 EOS_NAMESPACE_BEGIN
 
 
+// The object can have been made with any alignment, so the allocator finds the size and the alignment by itself
 template<typename T, class Allocator>
 EOS_INLINE void Free(T* _object, Allocator* _allocator)
 {
@@ -20,6 +23,27 @@ EOS_INLINE void Free(T* _object, Allocator* _allocator)
 	_allocator->Free(_object);
 }
 
+// The size of the type and the alignment given at the allocation are given back to the allocator, only the polymorphic types
+// can be a derived object, so for them the allocator finds the size by itself
+template<typename T, class Allocator>
+EOS_INLINE void Free(T* _object, Allocator* _allocator, size _alignment)
+{
+	_object->~T();
+	Free(_object, _allocator, _alignment, MemUtils::IntToType<!std::is_polymorphic<T>::value>());
+}
+
+template<typename T, class Allocator>
+EOS_INLINE void Free(T* _object, Allocator* _allocator, size _alignment, MemUtils::IntToType<true>)
+{
+	_allocator->Free(_object, sizeof(T), _alignment);
+}
+
+template<typename T, class Allocator>
+EOS_INLINE void Free(T* _object, Allocator* _allocator, size, MemUtils::IntToType<false>)
+{
+	_allocator->Free(_object);
+}
+
 
 template<typename T, class Allocator>
 EOS_INLINE T* AllocArray(Allocator* _allocator, size _cnt, const char* _file, uint32 _line, MemUtils::NoPODType)
@@ -122,10 +146,13 @@ EOS_NAMESPACE_END
 
 #define eosNewAlignedRaw(Size, Allocator, Alignment)	 (Allocator)->Allocate(Size, Alignment, EOS_ALLOCATION_INFO)
 #define eosDeleteRaw(Ptr, Allocator)					 (Allocator)->Free(Ptr);
+#define eosNewBatchAlignedRaw(Count, Size, Allocator, Alignment, Out)	(Allocator)->AllocateBatch(Count, Size, Alignment, Out, EOS_ALLOCATION_INFO)
+#define eosDeleteBatchRaw(Ptrs, Count, Allocator)						(Allocator)->FreeBatch(Ptrs, Count);
 
 #define eosNewAligned(Type, Allocator, Alignment, ...)  new ((Allocator)->Allocate(sizeof(Type), Alignment, EOS_ALLOCATION_INFO)) Type(__VA_ARGS__)
 #define eosNew(Type, Allocator, ...)                    eosNewAligned(Type, (Allocator), alignof(Type), __VA_ARGS__)
 #define eosDelete(Object, Allocator)                    eos::Free((Object), (Allocator))
+#define eosDeleteAligned(Object, Allocator, Alignment)  eos::Free((Object), (Allocator), Alignment)
 
 #define eosReallocAligned(Ptr, Type, Allocator, Alignment)		(Allocator)->Reallocate(Ptr, sizeof(Type), Alignment, EOS_ALLOCATION_INFO)
 #define eosReallocAlignedRaw(Ptr, Size, Allocator, Alignment)	(Allocator)->Reallocate(Ptr, Size, Alignment, EOS_ALLOCATION_INFO)
@@ -10,21 +10,8 @@
 EOS_NAMESPACE_BEGIN
 
 
-#if defined(NDEBUG)
-
-class AllocationHeader : public NoCopyableMoveable
-{
-public:
-	static constexpr size kHeaderSize = 0;
-
-	EOS_INLINE void StoreSize(void*, size) { }
-	EOS_INLINE size GetSize(void*) { return 0; }
-};
-
-
-#else
-
-class AllocationHeader : public NoCopyableMoveable
+// The size of the allocation before it, also in release, for instance for the MemoryStats when the Free is without size
+class AllocationSizeHeader : public NoCopyableMoveable
 {
 public:
 	static constexpr size kHeaderSize = sizeof(uint32);
@@ -40,6 +27,23 @@ public:
 	}
 };
 
+
+#if defined(NDEBUG)
+
+class AllocationHeader : public NoCopyableMoveable
+{
+public:
+	static constexpr size kHeaderSize = 0;
+
+	EOS_INLINE void StoreSize(void*, size) { }
+	EOS_INLINE size GetSize(void*) { return 0; }
+};
+
+
+#else
+
+using AllocationHeader = AllocationSizeHeader;
+
 #endif
 
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "Core/BasicDefines.h"
 #include "Core/BasicTypes.h"
 
@@ -10,6 +10,8 @@
 
 #include "Core/BasicTypes.h"
 
+#include "MemoryLayoutUtils.h"
+
 
 EOS_NAMESPACE_BEGIN
 
@@ -31,6 +33,7 @@ public:
 	~MemoryLog() {}
 	EOS_INLINE void OnAllocation(void*, size, size, const LogSourceInfo&) const {}
 	EOS_INLINE void OnDeallocation(void*, size) const {}
+	EOS_INLINE void OnAllocationFailure(size, size, const LogSourceInfo&) const {}
 	EOS_INLINE size GetNumAllocations() const { return 0; }
 	EOS_INLINE size GetAllocatedSize() const { return 0; }
 	EOS_INLINE void Flush(size _allocated, size _used, size _total) {}
@@ -141,6 +144,11 @@ public:
 		}
 	}
 
+	// not in the file, to keep its layout
+	EOS_INLINE void OnAllocationFailure(size, size, const LogSourceInfo&) const
+	{
+	}
+
 	EOS_INLINE size GetNumAllocations() const
 	{
 		return m_numAllocations;
@@ -169,4 +177,39 @@ private:
 #endif
 
 
+namespace MemUtils
+{
+	// true for the log policies which want the header and the bounds added by the allocator to each size, having SetAllocationOverhead
+	template <typename T, typename = void>
+	struct HasAllocationOverhead
+	{
+		static const bool value = false;
+	};
+
+	template <typename T>
+	struct HasAllocationOverhead<T, decltype((void)&T::SetAllocationOverhead)>
+	{
+		static const bool value = true;
+	};
+
+	template<typename LogPolicy>
+	static EOS_INLINE void SetAllocationOverhead(LogPolicy& _log, size _overhead, IntToType<true>)
+	{
+		_log.SetAllocationOverhead(_overhead);
+	}
+
+	template<typename LogPolicy>
+	static EOS_INLINE void SetAllocationOverhead(LogPolicy&, size, IntToType<false>)
+	{
+	}
+
+	// the sizes given to the log policy are the ones of the blocks, this is how much of them the allocator added
+	template<typename LogPolicy>
+	static EOS_INLINE void SetAllocationOverhead(LogPolicy& _log, size _overhead)
+	{
+		SetAllocationOverhead(_log, _overhead, IntToType<HasAllocationOverhead<LogPolicy>::value>());
+	}
+}
+
+
 EOS_NAMESPACE_END
\ No newline at end of file
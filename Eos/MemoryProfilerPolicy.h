@@ -0,0 +1,439 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\MemoryProfilerPolicy.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <sstream>
+#include <unordered_map>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+
+#include "MemoryLogPolicy.h"
+
+#if defined(_WIN32)
+// the min and max macros would break std::numeric_limits used by the allocators
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <execinfo.h>
+#endif
+
+
+EOS_NAMESPACE_BEGIN
+
+
+namespace MemUtils
+{
+	// the return addresses of the callers, the first _skip frames are not taken, counting also the caller
+	static EOS_INLINE uint32 CaptureStackTrace(void** _frames, uint32 _maxDepth, uint32 _skip)
+	{
+#if defined(_WIN32)
+		return CaptureStackBackTrace(static_cast<DWORD>(_skip), static_cast<DWORD>(_maxDepth), _frames, nullptr);
+#else
+		void* frames[128];
+		const int depth = backtrace(frames, static_cast<int>(_maxDepth + _skip < 128 ? _maxDepth + _skip : 128));
+		const uint32 first = _skip;
+		if (depth <= static_cast<int>(first))
+		{
+			return 0;
+		}
+
+		const uint32 count = static_cast<uint32>(depth) - first < _maxDepth ? static_cast<uint32>(depth) - first : _maxDepth;
+		memcpy(_frames, frames + first, count * sizeof(void*));
+		return count;
+#endif
+	}
+}
+
+
+// Sampling heap profiler, as LogPolicy of the MemoryAllocator, also in release.
+// The allocations are sampled every SampleInterval bytes on average, with the distance between two samples taken
+// from an exponential distribution (a Poisson process on the bytes), so also the small allocations are found,
+// in proportion to the bytes they take.
+// Each thread counts down the bytes to its next sample, so an allocation not sampled costs only a subtraction.
+// A sample keeps the stack trace and the source info of the allocation, the samples still allocated are kept
+// in a side table until they are freed. The Free looks at a small counting filter first, without lock,
+// so only the frees of sampled allocations, and a few false positives, take the lock.
+// The samples are written in the legacy text heap profile of pprof, which has both the in use and the allocated columns:
+// pprof scales them back with the SampleInterval, and shows the allocations with -sample_index=alloc_space.
+// The events are also given to the LogPolicy, by default the MemoryLog, which writes them only in debug.
+template<class LogPolicy = MemoryLog, size SampleInterval = 512 * 1024, uint32 MaxStackDepth = 32>
+class MemoryHeapProfiler : public NoCopyableMoveable
+{
+private:
+	static_assert(SampleInterval > 0, "SampleInterval must be greater than 0");
+	static_assert(MaxStackDepth > 0 && MaxStackDepth <= 64, "MaxStackDepth must be between 1 and 64");
+
+	static constexpr uint32 kFilterBits = 14;
+	static constexpr uint32 kFilterSize = 1 << kFilterBits;
+
+	// only the frame taking the sample is skipped, the ones of the allocator stay at the top
+	static constexpr uint32 kSkipFrames = 1;
+
+	// trivial, so the thread local needs no construction
+	struct ThreadSampler
+	{
+		int64 m_bytesUntilSample;
+		uint64 m_random;
+	};
+
+	// the samples with the same stack trace and source info
+	struct Bucket
+	{
+		void* m_frames[MaxStackDepth];
+		uint32 m_depth;
+		const char* m_fileName;
+		uint32 m_lineNumber;
+
+		uint64 m_inUseCount;
+		uint64 m_inUseBytes;
+		uint64 m_allocatedCount;
+		uint64 m_allocatedBytes;
+	};
+
+	struct LiveSample
+	{
+		Bucket* m_bucket;
+		size m_size;
+	};
+
+public:
+	MemoryHeapProfiler(const char* _name) : m_log(_name)
+	{
+		for (uint32 i = 0; i < kFilterSize; ++i)
+		{
+			m_filter[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	~MemoryHeapProfiler() {}
+
+	EOS_INLINE void OnAllocation(void* _ptr, size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		ThreadSampler& sampler = GetThreadSampler();
+		sampler.m_bytesUntilSample -= static_cast<int64>(_size);
+		if (sampler.m_bytesUntilSample <= 0)
+		{
+			SampleAllocation(sampler, _ptr, _size, _info);
+		}
+
+		m_log.OnAllocation(_ptr, _size, _alignment, _info);
+	}
+
+	EOS_INLINE void OnDeallocation(void* _ptr, size _size)
+	{
+		// the filter is incremented before the pointer is given out, so 0 means it is not sampled
+		if (m_filter[GetFilterIndex(_ptr)].load(std::memory_order_relaxed) != 0)
+		{
+			RemoveSample(_ptr);
+		}
+
+		m_log.OnDeallocation(_ptr, _size);
+	}
+
+	EOS_INLINE void OnAllocationFailure(size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		m_log.OnAllocationFailure(_size, _alignment, _info);
+	}
+
+	EOS_INLINE size GetNumAllocations() const { return m_log.GetNumAllocations(); }
+	EOS_INLINE size GetAllocatedSize() const { return m_log.GetAllocatedSize(); }
+
+	EOS_INLINE void Flush(size _allocated, size _used, size _total)
+	{
+		m_log.Flush(_allocated, _used, _total);
+	}
+
+	// the samples keep the sizes of the blocks, the overhead is for the LogPolicy
+	EOS_INLINE void SetAllocationOverhead(size _overhead)
+	{
+		MemUtils::SetAllocationOverhead(m_log, _overhead);
+	}
+
+	// everything is freed, the allocated columns are kept
+	void Reset()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_liveSamples.clear();
+			for (Bucket& bucket : m_buckets)
+			{
+				bucket.m_inUseCount = 0;
+				bucket.m_inUseBytes = 0;
+			}
+			for (uint32 i = 0; i < kFilterSize; ++i)
+			{
+				m_filter[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		m_log.Reset();
+	}
+
+	// the snapshot of the LogPolicy, for instance the MemoryStats
+	template<typename Snapshot>
+	EOS_INLINE void GetSnapshot(Snapshot& _snapshot) const
+	{
+		m_log.GetSnapshot(_snapshot);
+	}
+
+	EOS_INLINE size GetLiveSampleCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_liveSamples.size();
+	}
+
+	// The heap profile of pprof, for instance "pprof -sample_index=inuse_space program profile.heap"
+	// On Linux the mapped libraries are written as well, so pprof can find the symbols.
+	void WriteHeapProfile(std::string& _out) const
+	{
+		std::ostringstream os;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			uint64 inUseCount = 0;
+			uint64 inUseBytes = 0;
+			uint64 allocatedCount = 0;
+			uint64 allocatedBytes = 0;
+			for (const Bucket& bucket : m_buckets)
+			{
+				inUseCount += bucket.m_inUseCount;
+				inUseBytes += bucket.m_inUseBytes;
+				allocatedCount += bucket.m_allocatedCount;
+				allocatedBytes += bucket.m_allocatedBytes;
+			}
+
+			os << "heap profile: " << inUseCount << ": " << inUseBytes << " [" << allocatedCount << ": " << allocatedBytes << "] @ heap_v2/" << SampleInterval << "\n";
+
+			for (const Bucket& bucket : m_buckets)
+			{
+				os << bucket.m_inUseCount << ": " << bucket.m_inUseBytes << " [" << bucket.m_allocatedCount << ": " << bucket.m_allocatedBytes << "] @";
+				for (uint32 i = 0; i < bucket.m_depth; ++i)
+				{
+					os << " 0x" << std::hex << (uintPtr)bucket.m_frames[i] << std::dec;
+				}
+				os << "\n";
+			}
+		}
+
+#if !defined(_WIN32)
+		FILE* maps = fopen("/proc/self/maps", "r");
+		if (maps != nullptr)
+		{
+			os << "\nMAPPED_LIBRARIES:\n";
+
+			char line[512];
+			while (fgets(line, sizeof(line), maps) != nullptr)
+			{
+				os << line;
+			}
+			fclose(maps);
+		}
+#endif
+
+		_out += os.str();
+	}
+
+	bool WriteHeapProfile(const char* _fileName) const
+	{
+		std::string text;
+		WriteHeapProfile(text);
+
+		FILE* file = nullptr;
+		if (fopen_s(&file, _fileName, "w") != 0)
+		{
+			return false;
+		}
+
+		const bool written = fputs(text.c_str(), file) >= 0;
+		fclose(file);
+		return written;
+	}
+
+	// The samples by source info as CSV, the values are the ones sampled, not scaled, the file is empty in release
+	void WriteSourceProfile(std::string& _out) const
+	{
+		struct SourceSamples
+		{
+			uint64 m_inUseCount;
+			uint64 m_inUseBytes;
+			uint64 m_allocatedCount;
+			uint64 m_allocatedBytes;
+		};
+
+		std::ostringstream os;
+		os << "File,Line,Live samples,Live sampled bytes,Samples,Sampled bytes" << std::endl;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			// the same source can be reached by many stack traces
+			std::unordered_map<std::string, SourceSamples> sources;
+			for (const Bucket& bucket : m_buckets)
+			{
+				std::ostringstream source;
+				source << (bucket.m_fileName != nullptr ? bucket.m_fileName : "") << "," << bucket.m_lineNumber;
+
+				SourceSamples& samples = sources.emplace(source.str(), SourceSamples{}).first->second;
+				samples.m_inUseCount += bucket.m_inUseCount;
+				samples.m_inUseBytes += bucket.m_inUseBytes;
+				samples.m_allocatedCount += bucket.m_allocatedCount;
+				samples.m_allocatedBytes += bucket.m_allocatedBytes;
+			}
+
+			for (const auto& it : sources)
+			{
+				os << it.first << "," << it.second.m_inUseCount << "," << it.second.m_inUseBytes << "," << it.second.m_allocatedCount << "," << it.second.m_allocatedBytes << std::endl;
+			}
+		}
+
+		_out += os.str();
+	}
+
+private:
+	static EOS_INLINE ThreadSampler& GetThreadSampler()
+	{
+		static thread_local ThreadSampler sampler;
+		return sampler;
+	}
+
+	static EOS_INLINE uint32 GetFilterIndex(void* _ptr)
+	{
+		return static_cast<uint32>((static_cast<uint64>((uintPtr)_ptr) * 0x9E3779B97F4A7C15ull) >> (64 - kFilterBits));
+	}
+
+	// exponential distribution with mean SampleInterval, from a xorshift64*
+	static int64 GetNextInterval(ThreadSampler& _sampler)
+	{
+		_sampler.m_random ^= _sampler.m_random >> 12;
+		_sampler.m_random ^= _sampler.m_random << 25;
+		_sampler.m_random ^= _sampler.m_random >> 27;
+		const uint64 random = _sampler.m_random * 0x2545F4914F6CDD1Dull;
+
+		// in (0, 1], so the logarithm is finite
+		const double uniform = static_cast<double>((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+		const double interval = -std::log(uniform) * static_cast<double>(SampleInterval);
+		return interval < 1.0 ? 1 : static_cast<int64>(interval);
+	}
+
+	void SampleAllocation(ThreadSampler& _sampler, void* _ptr, size _size, const LogSourceInfo& _info)
+	{
+		// the first allocation of the thread only starts the countdown
+		if (_sampler.m_random == 0)
+		{
+			_sampler.m_random = static_cast<uint64>(std::chrono::steady_clock::now().time_since_epoch().count()) ^ static_cast<uint64>((uintPtr)&_sampler) ^ 0x9E3779B97F4A7C15ull;
+			if (_sampler.m_random == 0)
+			{
+				_sampler.m_random = 1;
+			}
+
+			_sampler.m_bytesUntilSample += GetNextInterval(_sampler);
+			if (_sampler.m_bytesUntilSample > 0)
+			{
+				return;
+			}
+		}
+		_sampler.m_bytesUntilSample = GetNextInterval(_sampler);
+
+		void* frames[MaxStackDepth];
+		const uint32 depth = MemUtils::CaptureStackTrace(frames, MaxStackDepth, kSkipFrames);
+
+#if defined(NDEBUG)
+		(void)_info;
+		const char* fileName = nullptr;
+		const uint32 lineNumber = 0;
+#else
+		const char* fileName = _info.m_fileName;
+		const uint32 lineNumber = _info.m_lineNumber;
+#endif
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Bucket& bucket = GetBucket(frames, depth, fileName, lineNumber);
+		++bucket.m_inUseCount;
+		bucket.m_inUseBytes += _size;
+		++bucket.m_allocatedCount;
+		bucket.m_allocatedBytes += _size;
+
+		m_liveSamples[(uintPtr)_ptr] = { &bucket, _size };
+		m_filter[GetFilterIndex(_ptr)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void RemoveSample(void* _ptr)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_liveSamples.find((uintPtr)_ptr);
+		if (it == m_liveSamples.end())
+		{
+			return;
+		}
+
+		Bucket* bucket = it->second.m_bucket;
+		--bucket->m_inUseCount;
+		bucket->m_inUseBytes -= it->second.m_size;
+
+		m_liveSamples.erase(it);
+		m_filter[GetFilterIndex(_ptr)].fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// under the lock, the buckets are never removed so the live samples can point to them
+	Bucket& GetBucket(void* const* _frames, uint32 _depth, const char* _fileName, uint32 _lineNumber)
+	{
+		uint64 hash = 0xCBF29CE484222325ull ^ static_cast<uint64>((uintPtr)_fileName) ^ (static_cast<uint64>(_lineNumber) << 32);
+		for (uint32 i = 0; i < _depth; ++i)
+		{
+			hash = (hash ^ static_cast<uint64>((uintPtr)_frames[i])) * 0x100000001B3ull;
+		}
+
+		auto range = m_bucketIndex.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			Bucket* bucket = it->second;
+			if (bucket->m_depth == _depth && bucket->m_fileName == _fileName && bucket->m_lineNumber == _lineNumber &&
+				memcmp(bucket->m_frames, _frames, _depth * sizeof(void*)) == 0)
+			{
+				return *bucket;
+			}
+		}
+
+		m_buckets.emplace_back();
+		Bucket& bucket = m_buckets.back();
+		memcpy(bucket.m_frames, _frames, _depth * sizeof(void*));
+		bucket.m_depth = _depth;
+		bucket.m_fileName = _fileName;
+		bucket.m_lineNumber = _lineNumber;
+		bucket.m_inUseCount = 0;
+		bucket.m_inUseBytes = 0;
+		bucket.m_allocatedCount = 0;
+		bucket.m_allocatedBytes = 0;
+
+		m_bucketIndex.emplace(hash, &bucket);
+		return bucket;
+	}
+
+private:
+	// how many live samples have a pointer with the same index
+	std::atomic<uint32> m_filter[kFilterSize];
+
+	LogPolicy m_log;
+
+	mutable std::mutex m_mutex;
+	std::deque<Bucket> m_buckets;
+	std::unordered_multimap<uint64, Bucket*> m_bucketIndex;
+	std::unordered_map<uintPtr, LiveSample> m_liveSamples;
+};
+
+
+EOS_NAMESPACE_END
\ No newline at end of file
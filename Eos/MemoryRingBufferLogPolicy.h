@@ -0,0 +1,573 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\MemoryRingBufferLogPolicy.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+#include "DataStructures/DoublyLinkedList.h"
+
+#include "MemoryLogPolicy.h"
+
+
+EOS_NAMESPACE_BEGIN
+
+
+enum ERingBufferLogRecord
+{
+	ERingBufferLogRecord_Allocation,
+	ERingBufferLogRecord_Deallocation,
+	ERingBufferLogRecord_FileName,		// followed by m_size characters, the name of the file with the id in m_fileName
+	ERingBufferLogRecord_Dropped,		// m_size records of the ring in m_thread were lost, the ring was full
+	ERingBufferLogRecord_Summary		// followed by m_size bytes: allocations left, allocated size left, memory used and memory wasted
+};
+
+// The file starts with kRingBufferLogMagic, then the records, in the order they are taken from the rings
+struct RingBufferLogRecord
+{
+	uint32 m_type;
+	uint32 m_thread;		// the ring, each thread writes in its own
+	uint64 m_time;			// nanoseconds from the creation of the log
+	uint64 m_pointer;
+	uint64 m_size;
+	uint64 m_fileName;		// the address of the file name, 0 when there is no source info (release)
+	uint32 m_alignment;
+	uint32 m_line;
+};
+
+static constexpr char kRingBufferLogMagic[8] = { 'E', 'O', 'S', 'L', 'O', 'G', '0', '1' };
+
+
+// Asynchronous binary MemoryLog
+// Each thread writes fixed size records in its own ring, without lock, and a background thread writes them to the file.
+// When the ring of a thread is full the records are dropped and counted, so logging never waits for the file.
+// The writer drains the rings every DrainIntervalMicroseconds when they are empty, so a thread keeps all its records
+// while it logs less than RingCapacity of them in that time: with the defaults up to about 80 millions a second,
+// a burst of more than RingCapacity records right after a drain loses the rest until the next one.
+// Up to MaxThreads threads at the same time have a ring, the records of the others are dropped as well.
+// The file is converted to the CSV of the MemoryLog by MemUtils::ConvertRingBufferLog, see Tools/RingBufferLogToCsv.cpp.
+// It works also in release, but without the source info, which is not there.
+// The log must not be destroyed while other threads are still using it.
+template<uint32 RingCapacity = 8192, uint32 MaxThreads = 16, uint32 MaxLogsPerThread = 4, uint32 DrainIntervalMicroseconds = 100>
+class RingBufferMemoryLog : public NoCopyableMoveable
+{
+private:
+	static_assert((RingCapacity & (RingCapacity - 1)) == 0, "RingCapacity must be power of 2");
+	static_assert(DrainIntervalMicroseconds > 0, "DrainIntervalMicroseconds must be greater than 0");
+
+	// the head is written only by the thread, the tail only by the writer
+	struct Ring
+	{
+		alignas(64) std::atomic<uint32> m_head;
+		std::atomic<uint64> m_dropped;
+		std::atomic<int64> m_numAllocations;
+		std::atomic<int64> m_allocatedSize;
+
+		alignas(64) std::atomic<uint32> m_tail;
+		uint64 m_droppedWritten;
+		bool m_inUse;		// guarded by the registry mutex
+
+		RingBufferLogRecord m_records[RingCapacity];
+	};
+
+	struct ThreadRingData
+	{
+		std::atomic<RingBufferMemoryLog*> m_owner;
+		Ring* m_ring;
+	};
+
+	using ThreadRing = typename DoublyLinkedList<ThreadRingData>::Node;
+
+	// one for each thread, the rings are given back when the thread exits
+	struct ThreadRingRegistry
+	{
+		ThreadRingRegistry()
+		{
+			for (uint32 i = 0; i < MaxLogsPerThread; ++i)
+			{
+				m_rings[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~ThreadRingRegistry()
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+			for (uint32 i = 0; i < MaxLogsPerThread; ++i)
+			{
+				RingBufferMemoryLog* owner = m_rings[i].m_data.m_owner.load(std::memory_order_relaxed);
+				if (owner != nullptr)
+				{
+					owner->m_threadRings.Remove(&m_rings[i]);
+					m_rings[i].m_data.m_ring->m_inUse = false;
+					m_rings[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		ThreadRing m_rings[MaxLogsPerThread];
+	};
+
+public:
+	RingBufferMemoryLog(const char* _name) : m_file(nullptr), m_running(false), m_flushed(false)
+	{
+		m_threadRings.SetHead(nullptr);
+
+		m_rings = new Ring[MaxThreads];
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			m_rings[i].m_head.store(0, std::memory_order_relaxed);
+			m_rings[i].m_tail.store(0, std::memory_order_relaxed);
+			m_rings[i].m_dropped.store(0, std::memory_order_relaxed);
+			m_rings[i].m_numAllocations.store(0, std::memory_order_relaxed);
+			m_rings[i].m_allocatedSize.store(0, std::memory_order_relaxed);
+			m_rings[i].m_droppedWritten = 0;
+			m_rings[i].m_inUse = false;
+		}
+		m_overflowNumAllocations.store(0, std::memory_order_relaxed);
+		m_overflowAllocatedSize.store(0, std::memory_order_relaxed);
+		m_overflowDropped.store(0, std::memory_order_relaxed);
+		m_overflowDroppedWritten = 0;
+
+		m_start = std::chrono::steady_clock::now();
+
+		if (fopen_s(&m_file, (std::string(_name) + ".eoslog").c_str(), "wb") == 0)
+		{
+			fwrite(kRingBufferLogMagic, sizeof(kRingBufferLogMagic), 1, m_file);
+
+			m_running.store(true, std::memory_order_relaxed);
+			m_writer = std::thread(&RingBufferMemoryLog::WriterLoop, this);
+		}
+	}
+
+	~RingBufferMemoryLog()
+	{
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+			ThreadRing* threadRing = m_threadRings.GetHead();
+			while (threadRing != nullptr)
+			{
+				threadRing->m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+				threadRing = threadRing->m_next;
+			}
+			m_threadRings.SetHead(nullptr);
+		}
+
+		if (m_file != nullptr)
+		{
+			m_running.store(false, std::memory_order_release);
+			m_writer.join();
+
+			DrainRings();
+			if (m_flushed)
+			{
+				WriteSummary();
+			}
+
+			fclose(m_file);
+			m_file = nullptr;
+		}
+
+		delete[] m_rings;
+	}
+
+	// the summary is written after the last records, when the log is destroyed
+	void Flush(size _allocated, size _used, size _total)
+	{
+		m_summary[0] = GetNumAllocations();
+		m_summary[1] = _allocated;
+		m_summary[2] = _used;
+		m_summary[3] = _total - _used;
+		m_flushed = true;
+	}
+
+	EOS_INLINE void OnAllocation(void* _ptr, size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		Ring* ring = GetThreadRing();
+		if (ring == nullptr)
+		{
+			m_overflowNumAllocations.fetch_add(1, std::memory_order_relaxed);
+			m_overflowAllocatedSize.fetch_add(static_cast<int64>(_size), std::memory_order_relaxed);
+			m_overflowDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring->m_numAllocations.store(ring->m_numAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		ring->m_allocatedSize.store(ring->m_allocatedSize.load(std::memory_order_relaxed) + static_cast<int64>(_size), std::memory_order_relaxed);
+
+#if defined(NDEBUG)
+		(void)_info;
+		Push(ring, ERingBufferLogRecord_Allocation, _ptr, _size, _alignment, nullptr, 0);
+#else
+		Push(ring, ERingBufferLogRecord_Allocation, _ptr, _size, _alignment, _info.m_fileName, _info.m_lineNumber);
+#endif
+	}
+
+	EOS_INLINE void OnDeallocation(void* _ptr, size _size)
+	{
+		Ring* ring = GetThreadRing();
+		if (ring == nullptr)
+		{
+			m_overflowNumAllocations.fetch_sub(1, std::memory_order_relaxed);
+			m_overflowAllocatedSize.fetch_sub(static_cast<int64>(_size), std::memory_order_relaxed);
+			m_overflowDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring->m_numAllocations.store(ring->m_numAllocations.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+		ring->m_allocatedSize.store(ring->m_allocatedSize.load(std::memory_order_relaxed) - static_cast<int64>(_size), std::memory_order_relaxed);
+
+		Push(ring, ERingBufferLogRecord_Deallocation, _ptr, _size, 0, nullptr, 0);
+	}
+
+	// not in the file, to keep the layout of the MemoryLog
+	EOS_INLINE void OnAllocationFailure(size, size, const LogSourceInfo&) const
+	{
+	}
+
+	EOS_INLINE size GetNumAllocations() const
+	{
+		int64 numAllocations = m_overflowNumAllocations.load(std::memory_order_relaxed);
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			numAllocations += m_rings[i].m_numAllocations.load(std::memory_order_relaxed);
+		}
+		return static_cast<size>(numAllocations);
+	}
+
+	EOS_INLINE size GetAllocatedSize() const
+	{
+		int64 allocatedSize = m_overflowAllocatedSize.load(std::memory_order_relaxed);
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			allocatedSize += m_rings[i].m_allocatedSize.load(std::memory_order_relaxed);
+		}
+		return static_cast<size>(allocatedSize);
+	}
+
+	// the records lost because the rings were full, or because the thread had no ring.
+	// None while each thread logs less than RingCapacity records every DrainIntervalMicroseconds,
+	// a tight loop of allocations logs faster than that and loses the records above it.
+	EOS_INLINE uint64 GetDroppedRecords() const
+	{
+		uint64 dropped = m_overflowDropped.load(std::memory_order_relaxed);
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			dropped += m_rings[i].m_dropped.load(std::memory_order_relaxed);
+		}
+		return dropped;
+	}
+
+	EOS_INLINE void Reset()
+	{
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			m_rings[i].m_numAllocations.store(0, std::memory_order_relaxed);
+			m_rings[i].m_allocatedSize.store(0, std::memory_order_relaxed);
+		}
+		m_overflowNumAllocations.store(0, std::memory_order_relaxed);
+		m_overflowAllocatedSize.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	static std::mutex& GetRegistryMutex()
+	{
+		static std::mutex registryMutex;
+		return registryMutex;
+	}
+
+	static ThreadRingRegistry& GetRegistry()
+	{
+		static thread_local ThreadRingRegistry registry;
+		return registry;
+	}
+
+	// first call from a thread takes a ring for it, nullptr if there is no ring left or the thread has too many logs already
+	EOS_INLINE Ring* GetThreadRing()
+	{
+		ThreadRingRegistry& registry = GetRegistry();
+		for (uint32 i = 0; i < MaxLogsPerThread; ++i)
+		{
+			if (registry.m_rings[i].m_data.m_owner.load(std::memory_order_relaxed) == this)
+			{
+				return registry.m_rings[i].m_data.m_ring;
+			}
+		}
+
+		if (m_file == nullptr)
+		{
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+		for (uint32 i = 0; i < MaxLogsPerThread; ++i)
+		{
+			ThreadRing* threadRing = &registry.m_rings[i];
+			if (threadRing->m_data.m_owner.load(std::memory_order_relaxed) == nullptr)
+			{
+				for (uint32 j = 0; j < MaxThreads; ++j)
+				{
+					if (!m_rings[j].m_inUse)
+					{
+						m_rings[j].m_inUse = true;
+						threadRing->m_data.m_ring = &m_rings[j];
+						threadRing->m_data.m_owner.store(this, std::memory_order_relaxed);
+						m_threadRings.Push(threadRing);
+						return &m_rings[j];
+					}
+				}
+				return nullptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	EOS_INLINE void Push(Ring* _ring, ERingBufferLogRecord _type, void* _ptr, size _size, size _alignment, const char* _fileName, uint32 _line)
+	{
+		const uint32 head = _ring->m_head.load(std::memory_order_relaxed);
+		if (head - _ring->m_tail.load(std::memory_order_acquire) == RingCapacity)
+		{
+			_ring->m_dropped.store(_ring->m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+
+		RingBufferLogRecord& record = _ring->m_records[head & (RingCapacity - 1)];
+		record.m_type = _type;
+		record.m_thread = static_cast<uint32>(_ring - m_rings);
+		record.m_time = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+		record.m_pointer = (uintPtr)_ptr;
+		record.m_size = _size;
+		record.m_fileName = (uintPtr)_fileName;
+		record.m_alignment = static_cast<uint32>(_alignment);
+		record.m_line = _line;
+
+		_ring->m_head.store(head + 1, std::memory_order_release);
+	}
+
+	void WriterLoop()
+	{
+		while (m_running.load(std::memory_order_acquire))
+		{
+			if (!DrainRings())
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(DrainIntervalMicroseconds));
+			}
+		}
+	}
+
+	// only the writer thread, or the destructor after it is stopped
+	bool DrainRings()
+	{
+		bool drained = false;
+		for (uint32 i = 0; i < MaxThreads; ++i)
+		{
+			Ring& ring = m_rings[i];
+
+			const uint32 tail = ring.m_tail.load(std::memory_order_relaxed);
+			const uint32 head = ring.m_head.load(std::memory_order_acquire);
+			for (uint32 index = tail; index != head; ++index)
+			{
+				WriteRecord(ring.m_records[index & (RingCapacity - 1)]);
+			}
+			ring.m_tail.store(head, std::memory_order_release);
+			drained |= head != tail;
+
+			const uint64 dropped = ring.m_dropped.load(std::memory_order_relaxed);
+			if (dropped != ring.m_droppedWritten)
+			{
+				WriteDropped(i, dropped - ring.m_droppedWritten);
+				ring.m_droppedWritten = dropped;
+			}
+		}
+
+		const uint64 overflowDropped = m_overflowDropped.load(std::memory_order_relaxed);
+		if (overflowDropped != m_overflowDroppedWritten)
+		{
+			WriteDropped(MaxThreads, overflowDropped - m_overflowDroppedWritten);
+			m_overflowDroppedWritten = overflowDropped;
+		}
+
+		return drained;
+	}
+
+	// the file names are written once, before the first record using them
+	void WriteRecord(const RingBufferLogRecord& _record)
+	{
+		if (_record.m_fileName != 0 && m_fileNames.insert(_record.m_fileName).second)
+		{
+			const char* fileName = (const char*)(uintPtr)_record.m_fileName;
+
+			RingBufferLogRecord nameRecord = {};
+			nameRecord.m_type = ERingBufferLogRecord_FileName;
+			nameRecord.m_fileName = _record.m_fileName;
+			nameRecord.m_size = strlen(fileName);
+			fwrite(&nameRecord, sizeof(nameRecord), 1, m_file);
+			fwrite(fileName, 1, nameRecord.m_size, m_file);
+		}
+
+		fwrite(&_record, sizeof(_record), 1, m_file);
+	}
+
+	void WriteDropped(uint32 _thread, uint64 _count)
+	{
+		RingBufferLogRecord record = {};
+		record.m_type = ERingBufferLogRecord_Dropped;
+		record.m_thread = _thread;
+		record.m_size = _count;
+		fwrite(&record, sizeof(record), 1, m_file);
+	}
+
+	void WriteSummary()
+	{
+		RingBufferLogRecord record = {};
+		record.m_type = ERingBufferLogRecord_Summary;
+		record.m_size = sizeof(m_summary);
+		fwrite(&record, sizeof(record), 1, m_file);
+		fwrite(m_summary, sizeof(m_summary), 1, m_file);
+	}
+
+private:
+	Ring* m_rings;
+
+	// threads without a ring
+	std::atomic<int64> m_overflowNumAllocations;
+	std::atomic<int64> m_overflowAllocatedSize;
+	std::atomic<uint64> m_overflowDropped;
+	uint64 m_overflowDroppedWritten;
+
+	// rings of all the threads which used this log, guarded by the registry mutex
+	DoublyLinkedList<ThreadRingData> m_threadRings;
+
+	std::chrono::steady_clock::time_point m_start;
+
+	FILE* m_file;
+	std::thread m_writer;
+	std::atomic<bool> m_running;
+	std::unordered_set<uint64> m_fileNames;
+
+	uint64 m_summary[4];
+	bool m_flushed;
+};
+
+
+namespace MemUtils
+{
+	// Writes the records of a RingBufferMemoryLog file in the CSV of the MemoryLog, ordered by time
+	static EOS_INLINE bool ConvertRingBufferLog(const char* _logFileName, const char* _csvFileName, uint64& _droppedRecords)
+	{
+		_droppedRecords = 0;
+
+		FILE* logFile = nullptr;
+		if (fopen_s(&logFile, _logFileName, "rb") != 0)
+		{
+			return false;
+		}
+
+		char magic[sizeof(kRingBufferLogMagic)];
+		if (fread(magic, sizeof(magic), 1, logFile) != 1 || memcmp(magic, kRingBufferLogMagic, sizeof(magic)) != 0)
+		{
+			fclose(logFile);
+			return false;
+		}
+
+		std::vector<RingBufferLogRecord> records;
+		std::unordered_map<uint64, std::string> fileNames;
+		uint64 summary[4] = {};
+		bool hasSummary = false;
+
+		RingBufferLogRecord record;
+		while (fread(&record, sizeof(record), 1, logFile) == 1)
+		{
+			switch (record.m_type)
+			{
+			case ERingBufferLogRecord_Allocation:
+			case ERingBufferLogRecord_Deallocation:
+				records.push_back(record);
+				break;
+
+			case ERingBufferLogRecord_FileName:
+			{
+				std::string fileName(static_cast<size>(record.m_size), '\0');
+				if (record.m_size > 0 && fread(&fileName[0], 1, fileName.size(), logFile) != fileName.size())
+				{
+					fclose(logFile);
+					return false;
+				}
+				fileNames[record.m_fileName] = fileName;
+				break;
+			}
+
+			case ERingBufferLogRecord_Dropped:
+				_droppedRecords += record.m_size;
+				break;
+
+			case ERingBufferLogRecord_Summary:
+				if (record.m_size != sizeof(summary) || fread(summary, sizeof(summary), 1, logFile) != 1)
+				{
+					fclose(logFile);
+					return false;
+				}
+				hasSummary = true;
+				break;
+
+			default:
+				fclose(logFile);
+				return false;
+			}
+		}
+		fclose(logFile);
+
+		// each ring is in order, but the rings are written one after the other
+		std::stable_sort(records.begin(), records.end(), [](const RingBufferLogRecord& _a, const RingBufferLogRecord& _b) { return _a.m_time < _b.m_time; });
+
+		FILE* csvFile = nullptr;
+		if (fopen_s(&csvFile, _csvFileName, "w") != 0)
+		{
+			return false;
+		}
+
+		std::ostringstream os;
+		os << "Time(ms),Type,Pointer,Size,Alignment,File,Line" << std::endl;
+
+		for (const RingBufferLogRecord& it : records)
+		{
+			const uint64 ms = it.m_time / 1000000;
+			if (it.m_type == ERingBufferLogRecord_Allocation)
+			{
+				os << ms << "," << "Allocation,0x" << (void*)(uintPtr)it.m_pointer << "," << it.m_size << "," << it.m_alignment << "," << fileNames[it.m_fileName] << "," << it.m_line << std::endl;
+			}
+			else
+			{
+				os << ms << "," << "Deallocation,0x" << (void*)(uintPtr)it.m_pointer << "," << it.m_size << std::endl;
+			}
+		}
+
+		if (hasSummary)
+		{
+			os <<
+				std::endl << "Number allocation left,Memory allocation left,Memory used,Memory wasted" << std::endl <<
+				summary[0] << "," << summary[1] << "," << summary[2] << "," << summary[3] << std::endl;
+		}
+
+		const bool written = fputs(os.str().c_str(), csvFile) >= 0;
+		fclose(csvFile);
+		return written;
+	}
+}
+
+
+EOS_NAMESPACE_END
\ No newline at end of file
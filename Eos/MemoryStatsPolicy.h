@@ -0,0 +1,529 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\MemoryStatsPolicy.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <sstream>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+#include "Core/NumberUtils.h"
+#include "DataStructures/DoublyLinkedList.h"
+
+#include "MemoryLogPolicy.h"
+
+
+EOS_NAMESPACE_BEGIN
+
+
+namespace MemoryStatsUtils
+{
+	// the allocations are counted in power of 2 size classes, the first is up to 16 bytes and the last has all the bigger ones
+	static constexpr uint32 kSizeClassCount = 22;
+	static constexpr size kFirstSizeClassLimit = 16;
+
+	static EOS_INLINE uint32 GetSizeClass(size _size)
+	{
+		if (_size <= kFirstSizeClassLimit)
+		{
+			return 0;
+		}
+
+		const uint32 sizeClass = CoreUtils::FindLastSet64(static_cast<uint64>(_size - 1)) - 3;
+		return sizeClass < kSizeClassCount ? sizeClass : kSizeClassCount - 1;
+	}
+
+	// the biggest size of the class, 0 for the last one which has no limit
+	static EOS_INLINE size GetSizeClassLimit(uint32 _sizeClass)
+	{
+		return _sizeClass < kSizeClassCount - 1 ? kFirstSizeClassLimit << _sizeClass : 0;
+	}
+}
+
+
+// The counters of an allocator at the time of the snapshot
+struct MemoryStatsSnapshot
+{
+	const char* m_name;
+
+	uint64 m_allocations;
+	uint64 m_frees;
+	uint64 m_failures;
+	uint64 m_allocatedBytes;
+	uint64 m_liveAllocations;
+	uint64 m_liveBytes;
+	uint64 m_peakBytes;
+
+	uint64 m_sizeClasses[MemoryStatsUtils::kSizeClassCount];
+};
+
+
+// Always on statistics, also in release, as LogPolicy of the MemoryAllocator.
+// Each thread has its own block of counters for each MemoryStats it uses, written only by that thread with relaxed loads and stores,
+// so the threads never contend on them and there is no locked instruction, even when the allocator is used without lock.
+// The blocks are in a list summed by GetSnapshot, and the ones of the threads which exit are added to the totals of the MemoryStats.
+// A thread using more than MaxStatsPerThread of them counts on shared counters with atomic adds.
+// GetSnapshot does not stop the allocator, so a snapshot taken meanwhile can miss the allocations in flight.
+// The live bytes of each thread go to a shared counter once they change by PeakBatchSize bytes, the peak is taken from it
+// and from the bytes of the thread, so it can miss up to PeakBatchSize bytes for each other thread. With 0 it is exact,
+// with one atomic add for each event.
+// In release the Free without size knows the size only with a header storing it, see the AllocationSizeHeader,
+// otherwise the bytes are given back only by the sized Free.
+// The events are also given to the LogPolicy, by default the MemoryLog, which writes them only in debug.
+template<class LogPolicy = MemoryLog, int64 PeakBatchSize = 256, uint32 MaxStatsPerThread = 8>
+class MemoryStats : public NoCopyableMoveable
+{
+private:
+	static_assert(PeakBatchSize >= 0, "PeakBatchSize cannot be negative");
+
+	struct Counters
+	{
+		std::atomic<uint64> m_allocations;
+		std::atomic<uint64> m_frees;
+		std::atomic<uint64> m_failures;
+		std::atomic<uint64> m_allocatedBytes;
+		std::atomic<uint64> m_freedBytes;
+		std::atomic<int64> m_pendingBytes;		// not yet in m_liveBytes
+		std::atomic<uint64> m_sizeClasses[MemoryStatsUtils::kSizeClassCount];
+	};
+
+	// in its own cache lines, the owner is changed only under the registry mutex
+	struct alignas(64) ThreadCountersData
+	{
+		std::atomic<MemoryStats*> m_owner;
+		Counters m_counters;
+	};
+
+	using ThreadCounters = typename DoublyLinkedList<ThreadCountersData>::Node;
+
+	// one for each thread, the counters are added to the totals when the thread exits
+	struct ThreadCountersRegistry
+	{
+		ThreadCountersRegistry()
+		{
+			for (uint32 i = 0; i < MaxStatsPerThread; ++i)
+			{
+				m_counters[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~ThreadCountersRegistry()
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+			for (uint32 i = 0; i < MaxStatsPerThread; ++i)
+			{
+				MemoryStats* owner = m_counters[i].m_data.m_owner.load(std::memory_order_relaxed);
+				if (owner != nullptr)
+				{
+					owner->Retire(&m_counters[i]);
+					m_counters[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		ThreadCounters m_counters[MaxStatsPerThread];
+	};
+
+public:
+	MemoryStats(const char* _name) : m_log(_name), m_name(_name), m_liveBytes(0), m_peakBytes(0)
+	{
+		ClearCounters(m_sharedCounters);
+		ClearCounters(m_retiredCounters);
+		m_threadCounters.SetHead(nullptr);
+	}
+
+	// the MemoryStats must not be destroyed while other threads are still using it
+	~MemoryStats()
+	{
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+		ThreadCounters* counters = m_threadCounters.GetHead();
+		while (counters != nullptr)
+		{
+			counters->m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+			counters = counters->m_next;
+		}
+		m_threadCounters.SetHead(nullptr);
+	}
+
+	EOS_INLINE void OnAllocation(void* _ptr, size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		ThreadCounters* counters = GetThreadCounters();
+		if (counters != nullptr)
+		{
+			CountAllocation(counters->m_data.m_counters, _size, MemUtils::IntToType<true>());
+		}
+		else
+		{
+			CountAllocation(m_sharedCounters, _size, MemUtils::IntToType<false>());
+		}
+
+		m_log.OnAllocation(_ptr, _size, _alignment, _info);
+	}
+
+	EOS_INLINE void OnDeallocation(void* _ptr, size _size)
+	{
+		ThreadCounters* counters = GetThreadCounters();
+		if (counters != nullptr)
+		{
+			CountDeallocation(counters->m_data.m_counters, _size, MemUtils::IntToType<true>());
+		}
+		else
+		{
+			CountDeallocation(m_sharedCounters, _size, MemUtils::IntToType<false>());
+		}
+
+		m_log.OnDeallocation(_ptr, _size);
+	}
+
+	EOS_INLINE void OnAllocationFailure(size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		ThreadCounters* counters = GetThreadCounters();
+		if (counters != nullptr)
+		{
+			AddCounter(counters->m_data.m_counters.m_failures, static_cast<uint64>(1), MemUtils::IntToType<true>());
+		}
+		else
+		{
+			AddCounter(m_sharedCounters.m_failures, static_cast<uint64>(1), MemUtils::IntToType<false>());
+		}
+
+		m_log.OnAllocationFailure(_size, _alignment, _info);
+	}
+
+	EOS_INLINE size GetNumAllocations() const
+	{
+		MemoryStatsSnapshot snapshot;
+		uint64 freedBytes;
+		SumCounters(snapshot, freedBytes);
+		return static_cast<size>(snapshot.m_allocations - snapshot.m_frees);
+	}
+
+	EOS_INLINE size GetAllocatedSize() const
+	{
+		MemoryStatsSnapshot snapshot;
+		uint64 freedBytes;
+		SumCounters(snapshot, freedBytes);
+		return static_cast<size>(snapshot.m_allocatedBytes - freedBytes);
+	}
+
+	void GetSnapshot(MemoryStatsSnapshot& _snapshot) const
+	{
+		uint64 freedBytes;
+		SumCounters(_snapshot, freedBytes);
+		_snapshot.m_name = m_name;
+
+		// the counters are read one by one, so the frees can be ahead of the allocations
+		_snapshot.m_liveAllocations = _snapshot.m_allocations > _snapshot.m_frees ? _snapshot.m_allocations - _snapshot.m_frees : 0;
+		_snapshot.m_liveBytes = _snapshot.m_allocatedBytes > freedBytes ? _snapshot.m_allocatedBytes - freedBytes : 0;
+
+		const uint64 peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+		_snapshot.m_peakBytes = peakBytes > _snapshot.m_liveBytes ? peakBytes : _snapshot.m_liveBytes;
+	}
+
+	EOS_INLINE void Flush(size _allocated, size _used, size _total)
+	{
+		m_log.Flush(_allocated, _used, _total);
+	}
+
+	// the counters keep the sizes of the blocks, only the LogPolicy is told about the overhead
+	EOS_INLINE void SetAllocationOverhead(size _overhead)
+	{
+		MemUtils::SetAllocationOverhead(m_log, _overhead);
+	}
+
+	// the allocations left are counted as freed, so the counters never go back.
+	// The counters of the threads are written only by them, so the shared ones take the difference.
+	void Reset()
+	{
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+			MemoryStatsSnapshot snapshot;
+			uint64 freedBytes;
+			int64 pendingBytes;
+			SumCountersUnlocked(snapshot, freedBytes, pendingBytes);
+
+			AddCounter(m_sharedCounters.m_frees, snapshot.m_allocations - snapshot.m_frees, MemUtils::IntToType<false>());
+			AddCounter(m_sharedCounters.m_freedBytes, snapshot.m_allocatedBytes - freedBytes, MemUtils::IntToType<false>());
+			m_liveBytes.store(-pendingBytes, std::memory_order_relaxed);
+		}
+
+		m_log.Reset();
+	}
+
+private:
+	static std::mutex& GetRegistryMutex()
+	{
+		static std::mutex registryMutex;
+		return registryMutex;
+	}
+
+	static ThreadCountersRegistry& GetRegistry()
+	{
+		static thread_local ThreadCountersRegistry registry;
+		return registry;
+	}
+
+	static void ClearCounters(Counters& _counters)
+	{
+		_counters.m_allocations.store(0, std::memory_order_relaxed);
+		_counters.m_frees.store(0, std::memory_order_relaxed);
+		_counters.m_failures.store(0, std::memory_order_relaxed);
+		_counters.m_allocatedBytes.store(0, std::memory_order_relaxed);
+		_counters.m_freedBytes.store(0, std::memory_order_relaxed);
+		_counters.m_pendingBytes.store(0, std::memory_order_relaxed);
+		for (uint32 i = 0; i < MemoryStatsUtils::kSizeClassCount; ++i)
+		{
+			_counters.m_sizeClasses[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	// only the owner thread writes its counters, the shared ones are written by all the threads
+	template<typename T>
+	static EOS_INLINE T AddCounter(std::atomic<T>& _counter, T _value, MemUtils::IntToType<true>)
+	{
+		const T value = _counter.load(std::memory_order_relaxed) + _value;
+		_counter.store(value, std::memory_order_relaxed);
+		return value;
+	}
+
+	template<typename T>
+	static EOS_INLINE T AddCounter(std::atomic<T>& _counter, T _value, MemUtils::IntToType<false>)
+	{
+		return _counter.fetch_add(_value, std::memory_order_relaxed) + _value;
+	}
+
+	template<bool Owned>
+	EOS_INLINE void CountAllocation(Counters& _counters, size _size, MemUtils::IntToType<Owned> _owned)
+	{
+		AddCounter(_counters.m_allocations, static_cast<uint64>(1), _owned);
+		AddCounter(_counters.m_allocatedBytes, static_cast<uint64>(_size), _owned);
+		AddCounter(_counters.m_sizeClasses[MemoryStatsUtils::GetSizeClass(_size)], static_cast<uint64>(1), _owned);
+		AddLiveBytes(_counters, static_cast<int64>(_size), _owned);
+	}
+
+	template<bool Owned>
+	EOS_INLINE void CountDeallocation(Counters& _counters, size _size, MemUtils::IntToType<Owned> _owned)
+	{
+		AddCounter(_counters.m_frees, static_cast<uint64>(1), _owned);
+		AddCounter(_counters.m_freedBytes, static_cast<uint64>(_size), _owned);
+		AddLiveBytes(_counters, -static_cast<int64>(_size), _owned);
+	}
+
+	EOS_INLINE void AddLiveBytes(Counters& _counters, int64 _bytes, MemUtils::IntToType<true> _owned)
+	{
+		int64 pendingBytes = AddCounter(_counters.m_pendingBytes, _bytes, _owned);
+		if (pendingBytes >= PeakBatchSize || pendingBytes <= -PeakBatchSize)
+		{
+			m_liveBytes.fetch_add(pendingBytes, std::memory_order_relaxed);
+			_counters.m_pendingBytes.store(0, std::memory_order_relaxed);
+			pendingBytes = 0;
+		}
+
+		UpdatePeak(m_liveBytes.load(std::memory_order_relaxed) + pendingBytes);
+	}
+
+	EOS_INLINE void AddLiveBytes(Counters&, int64 _bytes, MemUtils::IntToType<false>)
+	{
+		UpdatePeak(m_liveBytes.fetch_add(_bytes, std::memory_order_relaxed) + _bytes);
+	}
+
+	// the peak is written only when it grows
+	EOS_INLINE void UpdatePeak(int64 _liveBytes)
+	{
+		uint64 peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+		while (_liveBytes > 0 && static_cast<uint64>(_liveBytes) > peakBytes && !m_peakBytes.compare_exchange_weak(peakBytes, static_cast<uint64>(_liveBytes), std::memory_order_relaxed))
+		{
+		}
+	}
+
+	// first call from a thread registers its counters, nullptr if the thread has too many MemoryStats already
+	EOS_INLINE ThreadCounters* GetThreadCounters()
+	{
+		ThreadCountersRegistry& registry = GetRegistry();
+		for (uint32 i = 0; i < MaxStatsPerThread; ++i)
+		{
+			if (registry.m_counters[i].m_data.m_owner.load(std::memory_order_relaxed) == this)
+			{
+				return &registry.m_counters[i];
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+		for (uint32 i = 0; i < MaxStatsPerThread; ++i)
+		{
+			ThreadCounters* counters = &registry.m_counters[i];
+			if (counters->m_data.m_owner.load(std::memory_order_relaxed) == nullptr)
+			{
+				ClearCounters(counters->m_data.m_counters);
+				counters->m_data.m_owner.store(this, std::memory_order_relaxed);
+				m_threadCounters.Push(counters);
+				return counters;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// under the registry mutex, the counters of a thread which exits
+	void Retire(ThreadCounters* _counters)
+	{
+		const Counters& counters = _counters->m_data.m_counters;
+		AddCounter(m_retiredCounters.m_allocations, counters.m_allocations.load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		AddCounter(m_retiredCounters.m_frees, counters.m_frees.load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		AddCounter(m_retiredCounters.m_failures, counters.m_failures.load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		AddCounter(m_retiredCounters.m_allocatedBytes, counters.m_allocatedBytes.load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		AddCounter(m_retiredCounters.m_freedBytes, counters.m_freedBytes.load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		for (uint32 i = 0; i < MemoryStatsUtils::kSizeClassCount; ++i)
+		{
+			AddCounter(m_retiredCounters.m_sizeClasses[i], counters.m_sizeClasses[i].load(std::memory_order_relaxed), MemUtils::IntToType<false>());
+		}
+		m_liveBytes.fetch_add(counters.m_pendingBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		m_threadCounters.Remove(_counters);
+	}
+
+	static void AddCounters(const Counters& _counters, MemoryStatsSnapshot& _sum, uint64& _freedBytes, int64& _pendingBytes)
+	{
+		_sum.m_allocations += _counters.m_allocations.load(std::memory_order_relaxed);
+		_sum.m_frees += _counters.m_frees.load(std::memory_order_relaxed);
+		_sum.m_failures += _counters.m_failures.load(std::memory_order_relaxed);
+		_sum.m_allocatedBytes += _counters.m_allocatedBytes.load(std::memory_order_relaxed);
+		_freedBytes += _counters.m_freedBytes.load(std::memory_order_relaxed);
+		_pendingBytes += _counters.m_pendingBytes.load(std::memory_order_relaxed);
+		for (uint32 i = 0; i < MemoryStatsUtils::kSizeClassCount; ++i)
+		{
+			_sum.m_sizeClasses[i] += _counters.m_sizeClasses[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	// under the registry mutex
+	void SumCountersUnlocked(MemoryStatsSnapshot& _sum, uint64& _freedBytes, int64& _pendingBytes) const
+	{
+		_sum = {};
+		_freedBytes = 0;
+		_pendingBytes = 0;
+
+		AddCounters(m_sharedCounters, _sum, _freedBytes, _pendingBytes);
+		AddCounters(m_retiredCounters, _sum, _freedBytes, _pendingBytes);
+		for (const ThreadCounters* counters = m_threadCounters.GetHead(); counters != nullptr; counters = counters->m_next)
+		{
+			AddCounters(counters->m_data.m_counters, _sum, _freedBytes, _pendingBytes);
+		}
+	}
+
+	void SumCounters(MemoryStatsSnapshot& _sum, uint64& _freedBytes) const
+	{
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+		int64 pendingBytes;
+		SumCountersUnlocked(_sum, _freedBytes, pendingBytes);
+	}
+
+private:
+	LogPolicy m_log;
+	const char* m_name;
+
+	Counters m_sharedCounters;		// of the threads with too many MemoryStats, and the frees of Reset
+	Counters m_retiredCounters;		// of the threads which exited, under the registry mutex
+
+	// counters of all the threads which used this MemoryStats, guarded by the registry mutex
+	DoublyLinkedList<ThreadCountersData> m_threadCounters;
+
+	std::atomic<int64> m_liveBytes;
+	std::atomic<uint64> m_peakBytes;
+};
+
+
+namespace MemUtils
+{
+	// OpenMetrics text of the snapshots, each allocator is a label of the same metrics
+	static EOS_INLINE void WriteOpenMetrics(const MemoryStatsSnapshot* _snapshots, size _count, std::string& _out)
+	{
+		struct Metric
+		{
+			const char* m_name;
+			const char* m_type;
+			const char* m_suffix;
+			const char* m_help;
+			uint64 MemoryStatsSnapshot::* m_value;
+		};
+
+		static const Metric kMetrics[] =
+		{
+			{ "eos_allocations", "counter", "_total", "Number of allocations.", &MemoryStatsSnapshot::m_allocations },
+			{ "eos_frees", "counter", "_total", "Number of frees.", &MemoryStatsSnapshot::m_frees },
+			{ "eos_allocation_failures", "counter", "_total", "Number of allocations failed.", &MemoryStatsSnapshot::m_failures },
+			{ "eos_live_allocations", "gauge", "", "Number of allocations not freed yet.", &MemoryStatsSnapshot::m_liveAllocations },
+			{ "eos_live_bytes", "gauge", "", "Bytes allocated and not freed yet.", &MemoryStatsSnapshot::m_liveBytes },
+			{ "eos_peak_bytes", "gauge", "", "Highest value of the live bytes.", &MemoryStatsSnapshot::m_peakBytes }
+		};
+
+		std::ostringstream os;
+
+		for (const Metric& metric : kMetrics)
+		{
+			os << "# TYPE " << metric.m_name << " " << metric.m_type << "\n";
+			os << "# HELP " << metric.m_name << " " << metric.m_help << "\n";
+			for (size i = 0; i < _count; ++i)
+			{
+				os << metric.m_name << metric.m_suffix << "{allocator=\"" << _snapshots[i].m_name << "\"} " << _snapshots[i].*metric.m_value << "\n";
+			}
+		}
+
+		// the buckets of a histogram are cumulative
+		os << "# TYPE eos_allocation_size_bytes histogram\n";
+		os << "# HELP eos_allocation_size_bytes Size of the allocations.\n";
+		for (size i = 0; i < _count; ++i)
+		{
+			const MemoryStatsSnapshot& snapshot = _snapshots[i];
+
+			uint64 count = 0;
+			for (uint32 j = 0; j < MemoryStatsUtils::kSizeClassCount; ++j)
+			{
+				count += snapshot.m_sizeClasses[j];
+
+				os << "eos_allocation_size_bytes_bucket{allocator=\"" << snapshot.m_name << "\",le=\"";
+				if (j < MemoryStatsUtils::kSizeClassCount - 1)
+				{
+					os << MemoryStatsUtils::GetSizeClassLimit(j);
+				}
+				else
+				{
+					os << "+Inf";
+				}
+				os << "\"} " << count << "\n";
+			}
+			os << "eos_allocation_size_bytes_count{allocator=\"" << snapshot.m_name << "\"} " << count << "\n";
+			os << "eos_allocation_size_bytes_sum{allocator=\"" << snapshot.m_name << "\"} " << snapshot.m_allocatedBytes << "\n";
+		}
+
+		os << "# EOF\n";
+
+		_out += os.str();
+	}
+
+	static EOS_INLINE bool WriteOpenMetrics(const MemoryStatsSnapshot* _snapshots, size _count, const char* _fileName)
+	{
+		std::string text;
+		WriteOpenMetrics(_snapshots, _count, text);
+
+		FILE* file = nullptr;
+		if (fopen_s(&file, _fileName, "w") != 0)
+		{
+			return false;
+		}
+
+		const bool written = fputs(text.c_str(), file) >= 0;
+		fclose(file);
+		return written;
+	}
+}
+
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -58,10 +58,11 @@ private:
 		const uint32 numBitsToSet = static_cast<uint32>(8 * (_size - (current - start)));
 		eosAssertReturnVoid(numBitsToSet <= 32, "numBitsToSet are %d, expected less or equal 32", numBitsToSet);
 
-		// Set the remaining bytes which did not fit into a uint32 above.
-		const uint32 mask = 0xFFFFFFFF >> (32 - numBitsToSet);
-		as_byte = current;
-		*as_u32 = (mask & _pattern) + (~mask & *as_u32);
+		// Set the remaining bytes which did not fit into a uint32 above, one at a time so nothing past the end is touched.
+		for (uint32 shift = 0; shift < numBitsToSet; shift += 8, ++current)
+		{
+			*current = static_cast<uint8>(_pattern >> shift);
+		}
 	}
 };
 
@@ -0,0 +1,393 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\MemoryTracePolicy.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+#include "Core/NumberUtils.h"
+
+#include "MemoryLogPolicy.h"
+
+
+EOS_NAMESPACE_BEGIN
+
+
+enum EMemoryTraceOperation
+{
+	EMemoryTraceOperation_Allocation,
+	EMemoryTraceOperation_Deallocation,
+	EMemoryTraceOperation_Failure,		// the allocation of m_size failed, there is no pointer
+	EMemoryTraceOperation_Reset			// all the allocations are gone
+};
+
+// The file starts with kMemoryTraceMagic, then the records in the order of the operations.
+// The pointers are replaced by ids, which are given again once freed, so the biggest id is the peak of the live allocations.
+struct MemoryTraceRecord
+{
+	uint64 m_time;				// nanoseconds from the creation of the trace
+	uint64 m_size;				// the size asked to the allocator, without its header and bounds
+	uint32 m_pointerId;			// from 1, 0 for the operations without pointer and for the pointers allocated before the trace
+	uint16 m_thread;			// threads are numbered in the order they first record
+	uint8 m_operation;
+	uint8 m_alignmentShift;		// the alignment is 1 << m_alignmentShift
+};
+
+static_assert(sizeof(MemoryTraceRecord) == 24, "MemoryTraceRecord must stay 24 bytes, it is the file format");
+
+static constexpr char kMemoryTraceMagic[8] = { 'E', 'O', 'S', 'T', 'R', 'C', '0', '2' };
+
+
+// Records every operation of the allocator in a compact binary file, <name>.eostrace, to replay it offline
+// on other allocators with MemUtils::ReplayMemoryTrace, see Tools/AllocatorReplay.cpp.
+// The records are kept in a buffer of BufferRecords and written when it is full, under a lock,
+// so it is slower than the RingBufferMemoryLog, but it never drops a record, which the replay needs.
+// It works also in release, the source info is not recorded.
+// The events are also given to the LogPolicy, by default the MemoryLog, which writes them only in debug.
+template<class LogPolicy = MemoryLog, uint32 BufferRecords = 4096>
+class MemoryTraceLog : public NoCopyableMoveable
+{
+private:
+	static_assert(BufferRecords > 0, "BufferRecords must be greater than 0");
+
+public:
+	MemoryTraceLog(const char* _name) : m_log(_name), m_file(nullptr), m_nextPointerId(1), m_recordCount(0), m_allocationOverhead(0)
+	{
+		m_records.reserve(BufferRecords);
+		m_start = std::chrono::steady_clock::now();
+
+		if (fopen_s(&m_file, (std::string(_name) + ".eostrace").c_str(), "wb") == 0)
+		{
+			fwrite(kMemoryTraceMagic, sizeof(kMemoryTraceMagic), 1, m_file);
+		}
+	}
+
+	~MemoryTraceLog()
+	{
+		if (m_file != nullptr)
+		{
+			WriteRecords();
+			fclose(m_file);
+			m_file = nullptr;
+		}
+	}
+
+	EOS_INLINE void OnAllocation(void* _ptr, size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			uint32 pointerId;
+			if (m_freePointerIds.empty())
+			{
+				pointerId = m_nextPointerId++;
+			}
+			else
+			{
+				pointerId = m_freePointerIds.back();
+				m_freePointerIds.pop_back();
+			}
+			m_pointerIds[(uintPtr)_ptr] = pointerId;
+
+			AddRecord(EMemoryTraceOperation_Allocation, pointerId, _size - m_allocationOverhead, _alignment);
+		}
+
+		m_log.OnAllocation(_ptr, _size, _alignment, _info);
+	}
+
+	EOS_INLINE void OnDeallocation(void* _ptr, size _size)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			uint32 pointerId = 0;
+			auto it = m_pointerIds.find((uintPtr)_ptr);
+			if (it != m_pointerIds.end())
+			{
+				pointerId = it->second;
+				m_freePointerIds.push_back(pointerId);
+				m_pointerIds.erase(it);
+			}
+
+			AddRecord(EMemoryTraceOperation_Deallocation, pointerId, _size - m_allocationOverhead, 0);
+		}
+
+		m_log.OnDeallocation(_ptr, _size);
+	}
+
+	EOS_INLINE void OnAllocationFailure(size _size, size _alignment, const LogSourceInfo& _info)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			AddRecord(EMemoryTraceOperation_Failure, 0, _size - m_allocationOverhead, _alignment);
+		}
+
+		m_log.OnAllocationFailure(_size, _alignment, _info);
+	}
+
+	EOS_INLINE size GetNumAllocations() const { return m_log.GetNumAllocations(); }
+	EOS_INLINE size GetAllocatedSize() const { return m_log.GetAllocatedSize(); }
+
+	// set by the MemoryAllocator before the first allocation, the trace keeps the sizes asked so they can be replayed on any allocator
+	EOS_INLINE void SetAllocationOverhead(size _overhead)
+	{
+		m_allocationOverhead = _overhead;
+		MemUtils::SetAllocationOverhead(m_log, _overhead);
+	}
+
+	// the records still in the buffer are written as well, so the file is complete up to here
+	void Flush(size _allocated, size _used, size _total)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_file != nullptr)
+			{
+				WriteRecords();
+				fflush(m_file);
+			}
+		}
+
+		m_log.Flush(_allocated, _used, _total);
+	}
+
+	void Reset()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_pointerIds.clear();
+			m_freePointerIds.clear();
+			m_nextPointerId = 1;
+
+			AddRecord(EMemoryTraceOperation_Reset, 0, 0, 0);
+		}
+
+		m_log.Reset();
+	}
+
+	// the snapshot of the LogPolicy, for instance the MemoryStats
+	template<typename Snapshot>
+	EOS_INLINE void GetSnapshot(Snapshot& _snapshot) const
+	{
+		m_log.GetSnapshot(_snapshot);
+	}
+
+	EOS_INLINE uint64 GetRecordCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_recordCount;
+	}
+
+private:
+	// the threads get a number the first time they record
+	static uint16 GetThreadIndex()
+	{
+		static std::atomic<uint32> nextThreadIndex(0);
+		static thread_local uint32 threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+		return static_cast<uint16>(threadIndex);
+	}
+
+	// under the lock
+	EOS_INLINE void AddRecord(EMemoryTraceOperation _operation, uint32 _pointerId, size _size, size _alignment)
+	{
+		if (m_file == nullptr)
+		{
+			return;
+		}
+
+		MemoryTraceRecord record;
+		record.m_time = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+		record.m_size = _size;
+		record.m_pointerId = _pointerId;
+		record.m_thread = GetThreadIndex();
+		record.m_operation = static_cast<uint8>(_operation);
+		record.m_alignmentShift = static_cast<uint8>(_alignment > 0 ? CoreUtils::FindLastSet64(static_cast<uint64>(_alignment)) : 0);
+
+		m_records.push_back(record);
+		++m_recordCount;
+
+		if (m_records.size() == BufferRecords)
+		{
+			WriteRecords();
+		}
+	}
+
+	// under the lock
+	void WriteRecords()
+	{
+		if (!m_records.empty())
+		{
+			fwrite(m_records.data(), sizeof(MemoryTraceRecord), m_records.size(), m_file);
+			m_records.clear();
+		}
+	}
+
+private:
+	LogPolicy m_log;
+
+	mutable std::mutex m_mutex;
+	FILE* m_file;
+	std::vector<MemoryTraceRecord> m_records;
+
+	std::unordered_map<uintPtr, uint32> m_pointerIds;
+	std::vector<uint32> m_freePointerIds;
+	uint32 m_nextPointerId;
+	uint64 m_recordCount;
+	size m_allocationOverhead;
+
+	std::chrono::steady_clock::time_point m_start;
+};
+
+
+// What ReplayMemoryTrace measured
+struct MemoryTraceReplayResult
+{
+	uint64 m_operations;
+	uint64 m_failures;				// allocations the replay could not do
+	uint64 m_recordedFailures;		// allocations which had failed when recorded
+	double m_seconds;
+
+	size m_peakUsedMemory;			// the peak of GetUsedMemory of the allocator
+	size m_peakRequestedMemory;		// the peak of the live sizes of the trace
+	size m_peakRecord;				// the number of records replayed when the used memory was at its peak
+};
+
+
+namespace MemUtils
+{
+	// Reads all the records of a MemoryTraceLog file
+	static EOS_INLINE bool ReadMemoryTrace(const char* _fileName, std::vector<MemoryTraceRecord>& _records)
+	{
+		_records.clear();
+
+		FILE* file = nullptr;
+		if (fopen_s(&file, _fileName, "rb") != 0)
+		{
+			return false;
+		}
+
+		char magic[sizeof(kMemoryTraceMagic)];
+		if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, kMemoryTraceMagic, sizeof(magic)) != 0)
+		{
+			fclose(file);
+			return false;
+		}
+
+		MemoryTraceRecord records[1024];
+		size count;
+		while ((count = fread(records, sizeof(MemoryTraceRecord), 1024, file)) > 0)
+		{
+			_records.insert(_records.end(), records, records + count);
+		}
+
+		const bool read = ferror(file) == 0;
+		fclose(file);
+		return read;
+	}
+
+	// Replays the first _recordCount records of a trace on any MemoryAllocator, one after the other from this thread,
+	// so the threads of the trace are serialized in the order they were recorded and the time between the operations is not kept.
+	// The sizes of the trace are the ones asked to the recording allocator, the replay asks for the same ones and its allocator adds its own header and bounds.
+	// The allocations still alive at the end of the trace are left in the allocator.
+	template<typename Allocator>
+	static EOS_INLINE void ReplayMemoryTrace(Allocator& _allocator, const std::vector<MemoryTraceRecord>& _records, size _recordCount, MemoryTraceReplayResult& _result)
+	{
+		memset(&_result, 0, sizeof(_result));
+
+		_recordCount = _recordCount < _records.size() ? _recordCount : _records.size();
+
+		uint32 maxPointerId = 0;
+		for (size i = 0; i < _recordCount; ++i)
+		{
+			maxPointerId = _records[i].m_pointerId > maxPointerId ? _records[i].m_pointerId : maxPointerId;
+		}
+
+		std::vector<void*> pointers(static_cast<size>(maxPointerId) + 1, nullptr);
+		std::vector<size> sizes(static_cast<size>(maxPointerId) + 1, 0);
+		size requestedMemory = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size i = 0; i < _recordCount; ++i)
+		{
+			const MemoryTraceRecord& record = _records[i];
+			const size alignment = static_cast<size>(1) << record.m_alignmentShift;
+
+			switch (record.m_operation)
+			{
+			case EMemoryTraceOperation_Allocation:
+			{
+				void* ptr = _allocator.Allocate(static_cast<size>(record.m_size), alignment, EOS_ALLOCATION_INFO);
+				if (ptr == nullptr)
+				{
+					++_result.m_failures;
+				}
+				else if (record.m_pointerId != 0)
+				{
+					pointers[record.m_pointerId] = ptr;
+					sizes[record.m_pointerId] = static_cast<size>(record.m_size);
+					requestedMemory += static_cast<size>(record.m_size);
+				}
+				break;
+			}
+
+			case EMemoryTraceOperation_Deallocation:
+				if (record.m_pointerId != 0 && pointers[record.m_pointerId] != nullptr)
+				{
+					_allocator.Free(pointers[record.m_pointerId]);
+					pointers[record.m_pointerId] = nullptr;
+					requestedMemory -= sizes[record.m_pointerId];
+				}
+				break;
+
+			case EMemoryTraceOperation_Failure:
+			{
+				// nobody had this memory, so it is given back at once when the replay gets it
+				++_result.m_recordedFailures;
+				void* ptr = _allocator.Allocate(static_cast<size>(record.m_size), alignment, EOS_ALLOCATION_INFO);
+				if (ptr == nullptr)
+				{
+					++_result.m_failures;
+				}
+				else
+				{
+					_allocator.Free(ptr);
+				}
+				break;
+			}
+
+			case EMemoryTraceOperation_Reset:
+				_allocator.Reset();
+				std::fill(pointers.begin(), pointers.end(), nullptr);
+				requestedMemory = 0;
+				break;
+
+			default:
+				break;
+			}
+
+			const size usedMemory = _allocator.GetUsedMemory();
+			if (usedMemory > _result.m_peakUsedMemory)
+			{
+				_result.m_peakUsedMemory = usedMemory;
+				_result.m_peakRecord = i + 1;
+			}
+			_result.m_peakRequestedMemory = requestedMemory > _result.m_peakRequestedMemory ? requestedMemory : _result.m_peakRequestedMemory;
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		_result.m_operations = _recordCount;
+		_result.m_seconds = std::chrono::duration<double>(end - start).count();
+	}
+}
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,413 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\MemoryVirtualUtils.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "Core/BasicDefines.h"
+#include "Core/BasicTypes.h"
+#include "Core/PointerUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+// the min and max macros would break std::numeric_limits used by the allocators
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+EOS_NAMESPACE_BEGIN
+
+// What the huge page memory really got from the system
+enum EHugePageBacking
+{
+	EHugePageBacking_None,			// normal pages, only the alignment is of a huge page
+	EHugePageBacking_Transparent,	// normal pages the kernel promotes to huge pages when it can (madvise MADV_HUGEPAGE)
+	EHugePageBacking_Explicit		// huge pages reserved by the system (MAP_HUGETLB or MEM_LARGE_PAGES)
+};
+
+
+namespace MemUtils
+{
+	static constexpr size kHugePageSize = 2 * 1024 * 1024;
+
+	struct FileMapping
+	{
+		void* m_address;
+		size m_size;
+		intPtr m_file;
+		intPtr m_mapping;
+	};
+
+	// The reserved memory has only the address range, any access is a fault until it is committed.
+	// Commit and decommit work on whole pages, the range is extended to the pages containing it.
+
+	static EOS_INLINE size GetVirtualPageSize()
+	{
+#if defined(_WIN32)
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		return static_cast<size>(systemInfo.dwPageSize);
+#else
+		return static_cast<size>(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	// nullptr if the address range cannot be reserved
+	static EOS_INLINE void* ReserveVirtualMemory(size _size)
+	{
+#if defined(_WIN32)
+		return VirtualAlloc(nullptr, _size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+		void* ptr = mmap(nullptr, _size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return ptr != MAP_FAILED ? ptr : nullptr;
+#endif
+	}
+
+	static EOS_INLINE void ReleaseVirtualMemory(void* _ptr, size _size)
+	{
+#if defined(_WIN32)
+		(void)_size;
+		VirtualFree(_ptr, 0, MEM_RELEASE);
+#else
+		munmap(_ptr, _size);
+#endif
+	}
+
+	static EOS_INLINE bool CommitVirtualMemory(void* _ptr, size _size)
+	{
+#if defined(_WIN32)
+		return VirtualAlloc(_ptr, _size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+		return mprotect(_ptr, _size, PROT_READ | PROT_WRITE) == 0;
+#endif
+	}
+
+	// the physical pages are given back and the range is not accessible anymore, the address range is still reserved
+	static EOS_INLINE void DecommitVirtualMemory(void* _ptr, size _size)
+	{
+#if defined(_WIN32)
+		VirtualFree(_ptr, _size, MEM_DECOMMIT);
+#else
+		madvise(_ptr, _size, MADV_DONTNEED);
+		mprotect(_ptr, _size, PROT_NONE);
+#endif
+	}
+
+	// Committed memory aligned to kHugePageSize, the size is rounded up to the huge page size.
+	// Tries the explicit huge pages first, then the transparent ones, and at last the normal pages.
+	static void* AllocateHugePageMemory(size& _size, EHugePageBacking& _backing)
+	{
+		_size = CoreUtils::AlignTop(_size, kHugePageSize);
+		_backing = EHugePageBacking_None;
+
+#if defined(_WIN32)
+		const size largePageSize = static_cast<size>(GetLargePageMinimum());
+		if (largePageSize > 0 && kHugePageSize % largePageSize == 0)
+		{
+			// it needs the "Lock pages in memory" privilege, otherwise it fails
+			void* ptr = VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (ptr != nullptr)
+			{
+				_backing = EHugePageBacking_Explicit;
+				return ptr;
+			}
+		}
+
+		// reserve more to find an aligned address, then take only the aligned range; another thread can take it meanwhile, so retry
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			void* reserved = VirtualAlloc(nullptr, _size + kHugePageSize, MEM_RESERVE, PAGE_NOACCESS);
+			if (reserved == nullptr)
+			{
+				return nullptr;
+			}
+			VirtualFree(reserved, 0, MEM_RELEASE);
+
+			void* ptr = VirtualAlloc((void*)CoreUtils::AlignTop((uintPtr)reserved, kHugePageSize), _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (ptr != nullptr)
+			{
+				return ptr;
+			}
+		}
+		return nullptr;
+#else
+#if defined(MAP_HUGETLB)
+		void* hugePtr = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (hugePtr != MAP_FAILED)
+		{
+			_backing = EHugePageBacking_Explicit;
+			return hugePtr;
+		}
+#endif
+
+		// map more to find an aligned address, then unmap the parts before and after
+		void* mapped = mmap(nullptr, _size + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapped == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		const uintPtr start = (uintPtr)mapped;
+		const uintPtr alignedStart = CoreUtils::AlignTop(start, kHugePageSize);
+		if (alignedStart > start)
+		{
+			munmap(mapped, alignedStart - start);
+		}
+		if (start + kHugePageSize > alignedStart)
+		{
+			munmap((void*)(alignedStart + _size), start + kHugePageSize - alignedStart);
+		}
+
+#if defined(MADV_HUGEPAGE)
+		if (madvise((void*)alignedStart, _size, MADV_HUGEPAGE) == 0)
+		{
+			_backing = EHugePageBacking_Transparent;
+		}
+#endif
+		return (void*)alignedStart;
+#endif
+	}
+
+	static EOS_INLINE void FreeHugePageMemory(void* _ptr, size _size)
+	{
+#if defined(_WIN32)
+		(void)_size;
+		VirtualFree(_ptr, 0, MEM_RELEASE);
+#else
+		munmap(_ptr, _size);
+#endif
+	}
+
+	// The highest node number + 1, so the nodes can be indexed by their number, some of them can be offline.
+	// 1 when the system has no NUMA or it cannot be queried
+	static uint32 GetNumaNodeCount()
+	{
+#if defined(_WIN32)
+		ULONG highestNode = 0;
+		return GetNumaHighestNodeNumber(&highestNode) ? static_cast<uint32>(highestNode) + 1 : 1;
+#else
+		FILE* file = fopen("/sys/devices/system/node/online", "r");
+		if (file == nullptr)
+		{
+			return 1;
+		}
+
+		char online[256] = {};
+		const bool isRead = fgets(online, sizeof(online), file) != nullptr;
+		fclose(file);
+
+		// ranges of node numbers, for instance "0-1,4,6-7"
+		uint32 highestNode = 0;
+		const char* current = online;
+		while (isRead && *current != '\0')
+		{
+			if (*current >= '0' && *current <= '9')
+			{
+				char* numberEnd = nullptr;
+				const uint32 node = static_cast<uint32>(strtoul(current, &numberEnd, 10));
+				highestNode = node > highestNode ? node : highestNode;
+				current = numberEnd;
+			}
+			else
+			{
+				++current;
+			}
+		}
+		return highestNode + 1;
+#endif
+	}
+
+	// node of the processor running the calling thread, 0 when it cannot be queried
+	static EOS_INLINE uint32 GetCurrentNumaNode()
+	{
+#if defined(_WIN32)
+		PROCESSOR_NUMBER processor;
+		USHORT node = 0;
+		GetCurrentProcessorNumberEx(&processor);
+		return GetNumaProcessorNodeEx(&processor, &node) ? static_cast<uint32>(node) : 0;
+#elif defined(SYS_getcpu)
+		unsigned int cpu = 0;
+		unsigned int node = 0;
+		return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<uint32>(node) : 0;
+#else
+		return 0;
+#endif
+	}
+
+	// Committed memory with the physical pages taken from the node.
+	// _bound is false when the memory could not be bound to the node, and it is normal memory then.
+	static void* AllocateNumaMemory(size _size, uint32 _node, bool& _bound)
+	{
+		_bound = false;
+
+#if defined(_WIN32)
+		void* ptr = VirtualAllocExNuma(GetCurrentProcess(), nullptr, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, _node);
+		if (ptr != nullptr)
+		{
+			_bound = true;
+			return ptr;
+		}
+		return VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		void* ptr = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ptr == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+#if defined(SYS_mbind)
+		// the pages are not touched yet, so they will be taken from the node at the first touch
+		static constexpr int kMemoryPolicyBind = 2;		// MPOL_BIND
+
+		// the nodes not fitting the mask are not bound
+		if (_node < sizeof(unsigned long) * 8)
+		{
+			const unsigned long nodeMask = 1ul << _node;
+			_bound = syscall(SYS_mbind, ptr, _size, kMemoryPolicyBind, &nodeMask, sizeof(nodeMask) * 8 + 1, 0) == 0;
+		}
+#endif
+		return ptr;
+#endif
+	}
+
+	static EOS_INLINE void FreeNumaMemory(void* _ptr, size _size)
+	{
+#if defined(_WIN32)
+		(void)_size;
+		VirtualFree(_ptr, 0, MEM_RELEASE);
+#else
+		munmap(_ptr, _size);
+#endif
+	}
+
+	// 0 when the file does not exist
+	static size GetFileSize(const char* _path)
+	{
+#if defined(_WIN32)
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA(_path, GetFileExInfoStandard, &attributes))
+		{
+			return 0;
+		}
+		return static_cast<size>((static_cast<uint64>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow);
+#else
+		struct stat fileStat;
+		return stat(_path, &fileStat) == 0 ? static_cast<size>(fileStat.st_size) : 0;
+#endif
+	}
+
+	// Maps the first _size bytes of the file, created or grown when needed, shared so the changes go to the file.
+	// When _base is not null the file is mapped exactly there or the mapping fails.
+	static bool MapFile(const char* _path, size _size, void* _base, FileMapping& _mapping)
+	{
+		_mapping.m_address = nullptr;
+		_mapping.m_size = _size;
+
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(_path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64>(_size) >> 32), static_cast<DWORD>(_size), nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* address = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, _size, _base);
+		if (address == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		_mapping.m_file = (intPtr)file;
+		_mapping.m_mapping = (intPtr)mapping;
+#else
+		const int file = open(_path, O_RDWR | O_CREAT, 0644);
+		if (file < 0)
+		{
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0 || (static_cast<size>(fileStat.st_size) < _size && ftruncate(file, static_cast<off_t>(_size)) != 0))
+		{
+			close(file);
+			return false;
+		}
+
+#if defined(MAP_FIXED_NOREPLACE)
+		const int fixedFlag = _base != nullptr ? MAP_FIXED_NOREPLACE : 0;
+#else
+		const int fixedFlag = 0;
+#endif
+		void* address = mmap(_base, _size, PROT_READ | PROT_WRITE, MAP_SHARED | fixedFlag, file, 0);
+		if (address == MAP_FAILED)
+		{
+			close(file);
+			return false;
+		}
+
+		// without MAP_FIXED_NOREPLACE the base is only a hint
+		if (_base != nullptr && address != _base)
+		{
+			munmap(address, _size);
+			close(file);
+			return false;
+		}
+
+		_mapping.m_file = file;
+		_mapping.m_mapping = 0;
+#endif
+
+		_mapping.m_address = address;
+		return true;
+	}
+
+	static void FlushFile(const FileMapping& _mapping)
+	{
+#if defined(_WIN32)
+		FlushViewOfFile(_mapping.m_address, _mapping.m_size);
+		FlushFileBuffers((HANDLE)_mapping.m_file);
+#else
+		msync(_mapping.m_address, _mapping.m_size, MS_SYNC);
+#endif
+	}
+
+	static void UnmapFile(FileMapping& _mapping)
+	{
+		if (_mapping.m_address == nullptr)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		UnmapViewOfFile(_mapping.m_address);
+		CloseHandle((HANDLE)_mapping.m_mapping);
+		CloseHandle((HANDLE)_mapping.m_file);
+#else
+		munmap(_mapping.m_address, _mapping.m_size);
+		close(static_cast<int>(_mapping.m_file));
+#endif
+
+		_mapping.m_address = nullptr;
+	}
+}
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\NumaLocalAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <new>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+#include "Core/Assertions.h"
+
+#include "MemoryAreaPolicy.h"
+#include "MemoryLogPolicy.h"
+#include "MemoryVirtualUtils.h"
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// One allocator for each NUMA node, each one on a NumaArea of its node.
+// Allocate uses the allocator of the node of the calling thread, Free gives the memory back to the allocator owning it, found by address.
+// With only one node it is the same of a single allocator, so it works on any machine.
+// With more than MaxNodes nodes, the threads of the nodes from MaxNodes on use the allocator of the node 0, so their memory is remote.
+// The threads of the same node share the allocator, so it should use the MultiThreadPolicy.
+template<class Allocator, uint32 MaxNodes = 8>
+class NumaLocalAllocator : public NoCopyableMoveable
+{
+public:
+	static constexpr bool kAllowedAllocationArray = Allocator::kAllowedAllocationArray;
+
+	NumaLocalAllocator(size _areaSizePerNode, const char* _name)
+	{
+		const uint32 nodeCount = MemUtils::GetNumaNodeCount();
+		m_nodeCount = nodeCount < MaxNodes ? nodeCount : MaxNodes;
+
+		for (uint32 i = 0; i < m_nodeCount; ++i)
+		{
+			m_areas[i] = new (m_areaStorage[i]) NumaArea(_areaSizePerNode, i);
+			m_allocators[i] = new (m_allocatorStorage[i]) Allocator(*m_areas[i], _name);
+		}
+	}
+
+	~NumaLocalAllocator()
+	{
+		for (uint32 i = 0; i < m_nodeCount; ++i)
+		{
+			m_allocators[i]->~Allocator();
+			m_areas[i]->~NumaArea();
+		}
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		return m_allocators[GetLocalNode()]->Allocate(_size, _alignment, _sourceInfo);
+	}
+
+	EOS_INLINE void Free(void* _ptr)
+	{
+		if (_ptr == nullptr)
+		{
+			return;
+		}
+
+		m_allocators[GetOwnerNode(_ptr)]->Free(_ptr);
+	}
+
+	EOS_INLINE void Free(void* _ptr, size _size, size _alignment)
+	{
+		if (_ptr == nullptr)
+		{
+			return;
+		}
+
+		m_allocators[GetOwnerNode(_ptr)]->Free(_ptr, _size, _alignment);
+	}
+
+	// the memory stays on the node owning it
+	EOS_INLINE void* Reallocate(void* _ptr, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		if (_ptr == nullptr)
+		{
+			return Allocate(_size, _alignment, _sourceInfo);
+		}
+
+		return m_allocators[GetOwnerNode(_ptr)]->Reallocate(_ptr, _size, _alignment, _sourceInfo);
+	}
+
+	EOS_INLINE uint32 GetNodeCount() const { return m_nodeCount; }
+	EOS_INLINE Allocator& GetNodeAllocator(uint32 _node) { return *m_allocators[_node]; }
+	EOS_INLINE const NumaArea& GetNodeArea(uint32 _node) const { return *m_areas[_node]; }
+
+	EOS_INLINE size GetUsedMemory() const { return Sum(&Allocator::GetUsedMemory); }
+	EOS_INLINE size GetTotalMemory() const { return Sum(&Allocator::GetTotalMemory); }
+	EOS_INLINE size GetNumAllocations() const { return Sum(&Allocator::GetNumAllocations); }
+	EOS_INLINE size GetAllocatedSize() const { return Sum(&Allocator::GetAllocatedSize); }
+
+private:
+	// the nodes without an allocator fall back to the node 0
+	EOS_INLINE uint32 GetLocalNode() const
+	{
+		const uint32 node = m_nodeCount > 1 ? MemUtils::GetCurrentNumaNode() : 0;
+		return node < m_nodeCount ? node : 0;
+	}
+
+	EOS_INLINE uint32 GetOwnerNode(void* _ptr) const
+	{
+		for (uint32 i = 1; i < m_nodeCount; ++i)
+		{
+			if (_ptr >= m_areas[i]->GetStart() && _ptr < m_areas[i]->GetEnd())
+			{
+				return i;
+			}
+		}
+		return 0;
+	}
+
+	EOS_INLINE size Sum(size(Allocator::*_getter)() const) const
+	{
+		size sum = 0;
+		for (uint32 i = 0; i < m_nodeCount; ++i)
+		{
+			sum += (m_allocators[i]->*_getter)();
+		}
+		return sum;
+	}
+
+private:
+	alignas(NumaArea) uint8 m_areaStorage[MaxNodes][sizeof(NumaArea)];
+	alignas(Allocator) uint8 m_allocatorStorage[MaxNodes][sizeof(Allocator)];
+
+	NumaArea* m_areas[MaxNodes];
+	Allocator* m_allocators[MaxNodes];
+
+	uint32 m_nodeCount;
+};
+
+
+EOS_NAMESPACE_END
\ No newline at end of file
@@ -39,11 +39,11 @@ public:
 };
 
 
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)>
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)>
 class StlAllocator
 {
 private:
-	template<typename U, typename AllocatorU, AllocatorU*(*_AllocatorCallbackU)(void), size AlignU = __alignof(T)>
+	template<typename U, typename AllocatorU, AllocatorU*(*_AllocatorCallbackU)(void), size AlignU>
 	friend class StlAllocator;
 
 public:
@@ -124,12 +124,12 @@ public:
 		return (pointer)pAllocation;
 	}
 
-	// Deallocate memory
+	// Deallocate memory, the count is the one given to allocate
 	void deallocate(void* p, size_type cnt)
 	{
 		eosAssert(m_allocator, "Allocator is null!");
 
-		m_allocator->Free(p);
+		m_allocator->Free(p, cnt * sizeof(value_type), Align);
 	}
 
 	// Call constructor
@@ -182,28 +182,28 @@ protected:
 
 
 // Another allocator of the same type can deallocate from this one
-template<typename T1, typename T2, typename Allocator1, typename Allocator2, Allocator1*(*_AllocatorCallback1)(void), Allocator2*(*_AllocatorCallback2)(void), size Align1 = _alignof(T1), size Align2 = _alignof(T2)>
+template<typename T1, typename T2, typename Allocator1, typename Allocator2, Allocator1*(*_AllocatorCallback1)(void), Allocator2*(*_AllocatorCallback2)(void), size Align1 = alignof(T1), size Align2 = alignof(T2)>
 inline bool operator==(const StlAllocator<T1, Allocator1, _AllocatorCallback1, Align1>& a, const StlAllocator<T2, Allocator2, _AllocatorCallback2, Align2>& b)
 {
 	return _AllocatorCallback1 == _AllocatorCallback2;
 }
 
 // Another allocator of the another type cannot deallocate from this one
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = _alignof(T), typename Other>
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T), typename Other>
 inline bool operator==(const StlAllocator<T, Allocator, _AllocatorCallback, Align>&, const Other&)
 {
 	return false;
 }
 
 // Another allocator of the same type can deallocate from this one
-template<typename T1, typename T2, typename Allocator1, typename Allocator2, Allocator1*(*_AllocatorCallback1)(void), Allocator2*(*_AllocatorCallback2)(void), size Align1 = _alignof(T1), size Align2 = _alignof(T2)>
+template<typename T1, typename T2, typename Allocator1, typename Allocator2, Allocator1*(*_AllocatorCallback1)(void), Allocator2*(*_AllocatorCallback2)(void), size Align1 = alignof(T1), size Align2 = alignof(T2)>
 inline bool operator!=(const StlAllocator<T1, Allocator1, _AllocatorCallback1, Align1>& a, const StlAllocator<T2, Allocator2, _AllocatorCallback2, Align2>& b)
 {
 	return _AllocatorCallback1 != _AllocatorCallback2;
 }
 
 // Another allocator of the another type cannot deallocate from this one
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = _alignof(T), typename Other>
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T), typename Other>
 inline bool operator!=(const StlAllocator<T, Allocator, _AllocatorCallback, Align>&, const Other&)
 {
 	return true;
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <list>
 #include <string>
 #include <fstream>
 #include <array>
@@ -17,6 +18,13 @@
 #include <set>
 
 #include "StlAllocator.h"
+#include "MemoryAreaPolicy.h"
+#include "MemoryThreadPolicy.h"
+#include "MemoryBoundsCheckPolicy.h"
+#include "MemoryTagPolicy.h"
+#include "MemoryLogPolicy.h"
+#include "Allocators/TlsfAllocator.h"
+#include "Allocators/SmallObjectAllocator.h"
 
 
 // are only by STL, so I know the library is the same for me
@@ -26,15 +34,15 @@
 EOS_NAMESPACE_BEGIN
 
 
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)> using Vector = std::vector<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)> using List = std::list<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)> using Stack = std::stack<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)> using Deque = std::deque<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(T)> using Queue = std::queue<T, Deque<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)> using Vector = std::vector<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)> using List = std::list<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)> using Stack = std::stack<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)> using Deque = std::deque<T, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(T)> using Queue = std::queue<T, Deque<T, Allocator, _AllocatorCallback, Align> >;
 
-template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = __alignof(std::pair<const K, V>)> using MapAllocator = StlAllocator<std::pair<const K, V>, Allocator, _AllocatorCallback, Align>;
-template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<K>, size Align = __alignof(std::pair<const K, V>)> using Map = std::map<K, V, Compare, MapAllocator<K, V, Allocator, _AllocatorCallback, Align>>;
-template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<K>, size Align = __alignof(std::pair<const K, V>)> using UnorderedMap = std::unordered_map<K, V, Compare, MapAllocator<K, V, Allocator, _AllocatorCallback, Align>>;
+template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), size Align = alignof(std::pair<const K, V>)> using MapAllocator = StlAllocator<std::pair<const K, V>, Allocator, _AllocatorCallback, Align>;
+template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<K>, size Align = alignof(std::pair<const K, V>)> using Map = std::map<K, V, Compare, MapAllocator<K, V, Allocator, _AllocatorCallback, Align>>;
+template<typename K, typename V, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<K>, size Align = alignof(std::pair<const K, V>)> using UnorderedMap = std::unordered_map<K, V, Compare, MapAllocator<K, V, Allocator, _AllocatorCallback, Align>>;
 
 template<class Allocator, Allocator*(*_AllocatorCallback)(void)> using String = std::basic_string<char, std::char_traits<char>, StlAllocator<char, Allocator, _AllocatorCallback>>;
 template<class Allocator, Allocator*(*_AllocatorCallback)(void)> using WString = std::basic_string<wchar_t, std::char_traits<wchar_t>, StlAllocator<wchar_t, Allocator, _AllocatorCallback>>;
@@ -47,8 +55,39 @@ template<class Allocator, Allocator*(*_AllocatorCallback)(void)> using WOStream
 template<class Allocator, Allocator*(*_AllocatorCallback)(void)> using WStringStream = std::basic_stringstream<wchar_t, std::char_traits<wchar_t>, StlAllocator<wchar_t, Allocator, _AllocatorCallback> >;
 template<class Allocator, Allocator*(*_AllocatorCallback)(void)> using WIStringStream = std::basic_istringstream<wchar_t, std::char_traits<wchar_t>, StlAllocator<wchar_t, Allocator, _AllocatorCallback> >;
 
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<T>, size Align = __alignof(T)> using Set = std::set<T, Compare, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
-template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Hasher = std::hash<T>, typename KeyEquality = std::equal_to<T>, size Align = __alignof(T)> using UnorderedSet = std::unordered_set<T, Hasher, KeyEquality, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Compare = std::less<T>, size Align = alignof(T)> using Set = std::set<T, Compare, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+template<typename T, typename Allocator, Allocator*(*_AllocatorCallback)(void), typename Hasher = std::hash<T>, typename KeyEquality = std::equal_to<T>, size Align = alignof(T)> using UnorderedSet = std::unordered_set<T, Hasher, KeyEquality, StlAllocator<T, Allocator, _AllocatorCallback, Align> >;
+
+
+///////////////////////////////////////////////////////////////////////////
+//                  DEFAULT ALLOCATOR
+///////////////////////////////////////////////////////////////////////////
+
+// The containers nodes (list, map, set) are small objects, so they go in the size classes, the vectors and strings storage bigger
+// than the biggest size class go in the TLSF part of the area.
+// Define EOS_STL_DEFAULT_AREA_SIZE before to include Eos to change the size of the area.
+#ifndef EOS_STL_DEFAULT_AREA_SIZE
+#define EOS_STL_DEFAULT_AREA_SIZE (64 * 1024 * 1024)
+#endif
+
+using StlDefaultAllocationPolicy = SmallObjectAllocationPolicy<TlsfAllocator>;
+using StlDefaultAllocator = MemoryAllocator<StlDefaultAllocationPolicy, MultiThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>;
+
+inline StlDefaultAllocator* GetStlDefaultAllocator()
+{
+	static HeapAreaR stlDefaultHeapArea(EOS_STL_DEFAULT_AREA_SIZE);
+	static StlDefaultAllocator stlDefaultAllocator(stlDefaultHeapArea, "StlDefaultAllocator");
+
+	return &stlDefaultAllocator;
+}
+
+template<typename T> using DefaultVector = Vector<T, StlDefaultAllocator, GetStlDefaultAllocator>;
+template<typename T> using DefaultList = List<T, StlDefaultAllocator, GetStlDefaultAllocator>;
+template<typename T> using DefaultDeque = Deque<T, StlDefaultAllocator, GetStlDefaultAllocator>;
+template<typename K, typename V, typename Compare = std::less<K>> using DefaultMap = Map<K, V, StlDefaultAllocator, GetStlDefaultAllocator, Compare>;
+template<typename T, typename Compare = std::less<T>> using DefaultSet = Set<T, StlDefaultAllocator, GetStlDefaultAllocator, Compare>;
+template<typename T, typename Hasher = std::hash<T>, typename KeyEquality = std::equal_to<T>> using DefaultUnorderedSet = UnorderedSet<T, StlDefaultAllocator, GetStlDefaultAllocator, Hasher, KeyEquality>;
+using DefaultString = String<StlDefaultAllocator, GetStlDefaultAllocator>;
 
 
 EOS_NAMESPACE_END
\ No newline at end of file
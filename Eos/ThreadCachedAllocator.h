@@ -0,0 +1,324 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Eos\ThreadCachedAllocator.h
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "Core/BasicTypes.h"
+#include "Core/NoCopyable.h"
+#include "Core/Assertions.h"
+#include "DataStructures/DoublyLinkedList.h"
+
+#include "MemCpy.h"
+#include "MemoryLogPolicy.h"
+#include "MemoryThreadPolicy.h"
+#include "Allocators/SmallObjectAllocator.h"
+
+
+EOS_NAMESPACE_BEGIN
+
+
+// Per thread cache in front of a MemoryAllocator
+// Each thread has a magazine (a bounded stack of free blocks) for each small object size class.
+// Allocate and Free of the small objects use only the magazine of the calling thread, without any lock.
+// When a magazine is empty it is refilled, and when it is full it is flushed, with half magazine of blocks in one lock hold.
+// When a thread exits its magazines are given back to the allocator.
+// The wrapped allocator is serialized by the ThreadPolicy of this class, so it should use the SingleThreadPolicy.
+// The allocator must not be destroyed while other threads are still using it.
+template<class Allocator, class ThreadPolicy = MultiThreadPolicy, uint32 MagazineSize = 32, uint32 MaxAllocatorsPerThread = 4>
+class ThreadCachedAllocator : public NoCopyableMoveable
+{
+private:
+	static_assert(MagazineSize >= 2, "MagazineSize must be at least 2");
+
+	struct CacheHeader
+	{
+		uint32 m_sizeClass;
+		uint32 m_offset;
+		size m_size;
+	};
+
+	static constexpr uint32 kUncachedSizeClass = ~0u;
+	static constexpr size kHeaderSpace = SmallObjectUtils::kMaxSizeClassAlignment;
+	static constexpr uint32 kBatchSize = MagazineSize / 2;
+
+	static_assert(sizeof(CacheHeader) <= kHeaderSpace, "CacheHeader does not fit in the header space");
+
+	struct Magazine
+	{
+		void* m_blocks[MagazineSize];
+		uint32 m_count;
+	};
+
+	struct ThreadCacheData
+	{
+		std::atomic<ThreadCachedAllocator*> m_owner;
+		Magazine m_magazines[SmallObjectUtils::kSizeClassCount];
+	};
+
+	using ThreadCache = typename DoublyLinkedList<ThreadCacheData>::Node;
+
+	// one for each thread, the caches are given back when the thread exits
+	struct ThreadCacheRegistry
+	{
+		ThreadCacheRegistry()
+		{
+			for (uint32 i = 0; i < MaxAllocatorsPerThread; ++i)
+			{
+				m_caches[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~ThreadCacheRegistry()
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+			for (uint32 i = 0; i < MaxAllocatorsPerThread; ++i)
+			{
+				ThreadCachedAllocator* owner = m_caches[i].m_data.m_owner.load(std::memory_order_relaxed);
+				if (owner != nullptr)
+				{
+					owner->Drain(&m_caches[i]);
+					owner->m_threadCaches.Remove(&m_caches[i]);
+					m_caches[i].m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		ThreadCache m_caches[MaxAllocatorsPerThread];
+	};
+
+public:
+	static constexpr bool kAllowedAllocationArray = Allocator::kAllowedAllocationArray;
+
+	ThreadCachedAllocator(Allocator* _allocator) : m_allocator(_allocator)
+	{
+		m_threadCaches.SetHead(nullptr);
+	}
+
+	~ThreadCachedAllocator()
+	{
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+		ThreadCache* cache = m_threadCaches.GetHead();
+		while (cache != nullptr)
+		{
+			Drain(cache);
+			cache->m_data.m_owner.store(nullptr, std::memory_order_relaxed);
+			cache = cache->m_next;
+		}
+		m_threadCaches.SetHead(nullptr);
+	}
+
+	EOS_INLINE void* Allocate(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		if (_size <= SmallObjectUtils::kMaxSmallObjectSize && _alignment <= kHeaderSpace)
+		{
+			ThreadCache* cache = GetThreadCache();
+			if (cache != nullptr)
+			{
+				const uint32 sizeClass = SmallObjectUtils::GetSizeClass(_size);
+				Magazine& magazine = cache->m_data.m_magazines[sizeClass];
+				if (magazine.m_count == 0)
+				{
+					Refill(magazine, sizeClass, _sourceInfo);
+				}
+
+				if (magazine.m_count > 0)
+				{
+					return magazine.m_blocks[--magazine.m_count];
+				}
+			}
+		}
+
+		return AllocateUncached(_size, _alignment, _sourceInfo);
+	}
+
+	EOS_INLINE void Free(void* _ptr)
+	{
+		if (_ptr == nullptr)
+		{
+			return;
+		}
+
+		const CacheHeader* header = GetHeader(_ptr);
+		if (header->m_sizeClass != kUncachedSizeClass)
+		{
+			ThreadCache* cache = GetThreadCache();
+			if (cache != nullptr)
+			{
+				Magazine& magazine = cache->m_data.m_magazines[header->m_sizeClass];
+				if (magazine.m_count == MagazineSize)
+				{
+					Flush(magazine, kBatchSize);
+				}
+
+				magazine.m_blocks[magazine.m_count++] = _ptr;
+				return;
+			}
+		}
+
+		m_thread.Enter();
+		m_allocator->Free(static_cast<uint8*>(_ptr) - header->m_offset);
+		m_thread.Leave();
+	}
+
+	// the header before the memory is needed anyway, to know the cache of the block
+	EOS_INLINE void Free(void* _ptr, size /*_size*/, size /*_alignment*/)
+	{
+		Free(_ptr);
+	}
+
+	EOS_INLINE void* Reallocate(void* _ptr, size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		if (_ptr == nullptr)
+		{
+			return Allocate(_size, _alignment, _sourceInfo);
+		}
+
+		const size allocationSize = GetHeader(_ptr)->m_size;
+		const size sizeToCopy = allocationSize > _size ? _size : allocationSize;
+
+		// on failure the old block is still valid and owned by the caller
+		void* newPtr = Allocate(_size, _alignment, _sourceInfo);
+		if (newPtr == nullptr)
+		{
+			return nullptr;
+		}
+
+		MemUtils::MemCpy(newPtr, _ptr, sizeToCopy);
+		Free(_ptr);
+
+		return newPtr;
+	}
+
+	// the blocks in the thread caches are counted as used by the wrapped allocator
+	EOS_INLINE size GetUsedMemory() const { return m_allocator->GetUsedMemory(); }
+	EOS_INLINE size GetTotalMemory() const { return m_allocator->GetTotalMemory(); }
+	EOS_INLINE size GetNumAllocations() const { return m_allocator->GetNumAllocations(); }
+	EOS_INLINE size GetAllocatedSize() const { return m_allocator->GetAllocatedSize(); }
+
+private:
+	static std::mutex& GetRegistryMutex()
+	{
+		static std::mutex registryMutex;
+		return registryMutex;
+	}
+
+	static ThreadCacheRegistry& GetRegistry()
+	{
+		static thread_local ThreadCacheRegistry registry;
+		return registry;
+	}
+
+	static EOS_INLINE CacheHeader* GetHeader(void* _ptr)
+	{
+		return reinterpret_cast<CacheHeader*>(static_cast<uint8*>(_ptr) - sizeof(CacheHeader));
+	}
+
+	// first call from a thread registers a cache for this allocator, nullptr if the thread has too many allocators already
+	EOS_INLINE ThreadCache* GetThreadCache()
+	{
+		ThreadCacheRegistry& registry = GetRegistry();
+		for (uint32 i = 0; i < MaxAllocatorsPerThread; ++i)
+		{
+			if (registry.m_caches[i].m_data.m_owner.load(std::memory_order_relaxed) == this)
+			{
+				return &registry.m_caches[i];
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+		for (uint32 i = 0; i < MaxAllocatorsPerThread; ++i)
+		{
+			ThreadCache* cache = &registry.m_caches[i];
+			if (cache->m_data.m_owner.load(std::memory_order_relaxed) == nullptr)
+			{
+				for (uint32 j = 0; j < SmallObjectUtils::kSizeClassCount; ++j)
+				{
+					cache->m_data.m_magazines[j].m_count = 0;
+				}
+				cache->m_data.m_owner.store(this, std::memory_order_relaxed);
+				m_threadCaches.Push(cache);
+				return cache;
+			}
+		}
+
+		return nullptr;
+	}
+
+	EOS_INLINE void* AllocateUncached(size _size, size _alignment, const LogSourceInfo& _sourceInfo)
+	{
+		const size headerSpace = _alignment > kHeaderSpace ? _alignment : kHeaderSpace;
+
+		m_thread.Enter();
+		uint8* buffer = static_cast<uint8*>(m_allocator->Allocate(_size + headerSpace, headerSpace, _sourceInfo));
+		m_thread.Leave();
+
+		if (buffer == nullptr)
+		{
+			return nullptr;
+		}
+
+		CacheHeader* header = GetHeader(buffer + headerSpace);
+		header->m_sizeClass = kUncachedSizeClass;
+		header->m_offset = static_cast<uint32>(headerSpace);
+		header->m_size = _size;
+
+		return buffer + headerSpace;
+	}
+
+	EOS_INLINE void Refill(Magazine& _magazine, uint32 _sizeClass, const LogSourceInfo& _sourceInfo)
+	{
+		const size blockSize = SmallObjectUtils::kSizeClasses[_sizeClass];
+
+		m_thread.Enter();
+		while (_magazine.m_count < kBatchSize)
+		{
+			uint8* buffer = static_cast<uint8*>(m_allocator->Allocate(blockSize + kHeaderSpace, kHeaderSpace, _sourceInfo));
+			if (buffer == nullptr)
+			{
+				break;
+			}
+
+			CacheHeader* header = GetHeader(buffer + kHeaderSpace);
+			header->m_sizeClass = _sizeClass;
+			header->m_offset = static_cast<uint32>(kHeaderSpace);
+			header->m_size = blockSize;
+
+			_magazine.m_blocks[_magazine.m_count++] = buffer + kHeaderSpace;
+		}
+		m_thread.Leave();
+	}
+
+	EOS_INLINE void Flush(Magazine& _magazine, uint32 _count)
+	{
+		m_thread.Enter();
+		while (_count > 0 && _magazine.m_count > 0)
+		{
+			m_allocator->Free(static_cast<uint8*>(_magazine.m_blocks[--_magazine.m_count]) - kHeaderSpace);
+			--_count;
+		}
+		m_thread.Leave();
+	}
+
+	void Drain(ThreadCache* _cache)
+	{
+		for (uint32 i = 0; i < SmallObjectUtils::kSizeClassCount; ++i)
+		{
+			Flush(_cache->m_data.m_magazines[i], MagazineSize);
+		}
+	}
+
+private:
+	Allocator* m_allocator;
+	ThreadPolicy m_thread;
+
+	// caches of all the threads which used this allocator, guarded by the registry mutex
+	DoublyLinkedList<ThreadCacheData> m_threadCaches;
+};
+
+
+EOS_NAMESPACE_END
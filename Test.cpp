@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <tchar.h>
 
+#include <atomic>
+#include <thread>
+
 #include "Eos/Eos.h"
 
 EOS_USING_NAMESPACE
@@ -101,6 +104,23 @@ int main()
 	Test* tDynamicArray = eosNewDynamicArray(Test, 4, &testLinearAllocator);
 	eosDeleteArray(tDynamicArray, &testLinearAllocator);
 
+	// the area is too small for all of them, so the allocator grows
+	HeapArea<256> growingHeapArea;
+	MemoryAllocator<GrowingLinearAllocationPolicy<>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testGrowingLinearAllocator(growingHeapArea, "Test_GrowingLinearAllocator");
+	for (int i = 0; i < 16; ++i)
+	{
+		Test* growingArray = eosNewArray(Test[8], &testGrowingLinearAllocator);
+		eosDeleteArray(growingArray, &testGrowingLinearAllocator);
+	}
+	testGrowingLinearAllocator.Reset();
+
+	// only the pages used are committed
+	VirtualArea virtualHeapArea(64 * 1024 * 1024);
+	MemoryAllocator<VirtualCommitAllocationPolicy<LinearAllocator>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testVirtualLinearAllocator(virtualHeapArea, "Test_VirtualLinearAllocator");
+	Test* virtualArray = eosNewArray(Test[64], &testVirtualLinearAllocator);
+	eosDeleteArray(virtualArray, &testVirtualLinearAllocator);
+	testVirtualLinearAllocator.Reset();
+
 
 	///////////////////////////////////////////////////////////////////////
 
@@ -113,6 +133,71 @@ int main()
 	Cat* mew1 = eosNew(Cat, &testPoolAllocator);
 	eosDelete(mew1, &testPoolAllocator);
 
+	void* catBatch[4];
+	const size catBatchCount = eosNewBatchAlignedRaw(4, sizeof(Cat), &testPoolAllocator, alignof(Cat), catBatch);
+	eosDeleteBatchRaw(catBatch, catBatchCount, &testPoolAllocator);
+
+	// the area holds few cats, the others are in the slabs added on demand
+	HeapArea<128> growingPoolHeapArea;
+	MemoryAllocator<GrowingPoolAllocationPolicy<sizeof(Cat), alignof(Cat), HeapChunkSource, 8, 25>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testGrowingPoolAllocator(growingPoolHeapArea, "Test_GrowingPoolAllocator");
+
+	Cat* growingCats[32];
+	for (int i = 0; i < 32; ++i)
+	{
+		growingCats[i] = eosNew(Cat, &testGrowingPoolAllocator);
+	}
+	for (int i = 0; i < 32; ++i)
+	{
+		eosDelete(growingCats[i], &testGrowingPoolAllocator);
+	}
+
+	HeapArea<512> concurrentPoolHeapArea;
+	MemoryAllocator<ConcurrentPoolAllocationPolicy<sizeof(Cat), alignof(Cat)>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testConcurrentPoolAllocator(concurrentPoolHeapArea, "Test_ConcurrentPoolAllocator");
+
+	Cat* mew2 = eosNew(Cat, &testConcurrentPoolAllocator);
+	Cat* mew3 = eosNew(Cat, &testConcurrentPoolAllocator);
+	eosDelete(mew2, &testConcurrentPoolAllocator);
+	eosDelete(mew3, &testConcurrentPoolAllocator);
+
+	// the same pool shared by some threads without lock, the ring buffer log is thread safe as well
+	// each thread marks its chunks and checks that no other thread got them meanwhile
+	{
+		HeapArea<4096> sharedPoolHeapArea;
+		MemoryAllocator<ConcurrentPoolAllocationPolicy<sizeof(Cat), alignof(Cat)>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, RingBufferMemoryLog<>> testSharedPoolAllocator(sharedPoolHeapArea, "Test_SharedConcurrentPoolAllocator");
+
+		std::atomic<uint32> sharedPoolErrors(0);
+		std::thread sharedPoolThreads[4];
+		for (uint32 t = 0; t < 4; ++t)
+		{
+			sharedPoolThreads[t] = std::thread([&testSharedPoolAllocator, &sharedPoolErrors, t]()
+			{
+				uint32* chunks[8];
+				for (uint32 round = 0; round < 2000; ++round)
+				{
+					for (uint32 i = 0; i < 8; ++i)
+					{
+						chunks[i] = static_cast<uint32*>(eosNewAlignedRaw(sizeof(Cat), &testSharedPoolAllocator, alignof(Cat)));
+						*chunks[i] = t;
+					}
+					for (uint32 i = 0; i < 8; ++i)
+					{
+						if (*chunks[i] != t)
+						{
+							sharedPoolErrors.fetch_add(1, std::memory_order_relaxed);
+						}
+						eosDeleteRaw(chunks[i], &testSharedPoolAllocator);
+					}
+				}
+			});
+		}
+		for (uint32 t = 0; t < 4; ++t)
+		{
+			sharedPoolThreads[t].join();
+		}
+
+		eosAssert(sharedPoolErrors.load() == 0 && testSharedPoolAllocator.GetUsedMemory() == 0, "A chunk of the concurrent pool was given to two threads");
+	}
+
 	// These 2 calls are to show that the pool allocator cannot use the array version, due is already allocated by the element count
 	// so simply get one by one.
 	// Uncomment to see the assert on console
@@ -144,6 +229,59 @@ int main()
 	eosDelete(kitty0, &testFreeListBestAllocator);
 	eosDelete(kitty1, &testFreeListBestAllocator);
 
+	// the free block after it is absorbed, so the buffer grows without being moved
+	void* growingBuffer = eosNewAlignedRaw(32, &testFreeListBestAllocator, 16);
+	growingBuffer = eosReallocAlignedRaw(growingBuffer, 128, &testFreeListBestAllocator, 16);
+	growingBuffer = eosReallocAlignedRaw(growingBuffer, 64, &testFreeListBestAllocator, 16);
+	eosDeleteRaw(growingBuffer, &testFreeListBestAllocator);
+
+	// same fit of the best search, without walking all the free blocks
+	HeapArea<1024> indexedFreeListHeapArea;
+	MemoryAllocator<FreeListIndexedSearchAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testFreeListIndexedAllocator(indexedFreeListHeapArea, "Test_FreeListIndexedAllocator");
+
+	Cat* indexedCats[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		indexedCats[i] = eosNew(Cat, &testFreeListIndexedAllocator);
+	}
+	eosDelete(indexedCats[1], &testFreeListIndexedAllocator);
+	eosDelete(indexedCats[3], &testFreeListIndexedAllocator);
+	indexedCats[1] = eosNew(Cat, &testFreeListIndexedAllocator);
+	eosDelete(indexedCats[0], &testFreeListIndexedAllocator);
+	eosDelete(indexedCats[1], &testFreeListIndexedAllocator);
+	eosDelete(indexedCats[2], &testFreeListIndexedAllocator);
+
+	// the blocks of the heap, from the start of the area
+	Cat* walkedCat = eosNew(Cat, &testFreeListBestAllocator);
+	void* walkedBuffer = eosNewAlignedRaw(24, &testFreeListBestAllocator, 64);
+
+	size walkedBlockCount = 0;
+	testFreeListBestAllocator.WalkHeap([&walkedBlockCount](const FreeListHeapBlock&)
+	{
+		++walkedBlockCount;
+	});
+
+	FreeListFragmentationReport fragmentationReport;
+	testFreeListBestAllocator.GetFragmentationReport(fragmentationReport);
+
+	eosDeleteRaw(walkedBuffer, &testFreeListBestAllocator);
+	eosDelete(walkedCat, &testFreeListBestAllocator);
+
+	///////////////////////////////////////////////////////////////////////
+
+	// the second run finds the cats of the first one, the file is only for the test so it can be overwritten when it cannot be mapped again
+	MappedFileArea mappedFileArea("Test_MappedFileArea.bin", 4096, nullptr, true);
+	eos::FreeListAllocator<EFreeListSearch_Best>::State mappedState;
+	const bool isMappedRestored = mappedFileArea.LoadState(mappedState);
+	FreeListAllocator testMappedFreeListAllocator(mappedFileArea, "Test_MappedFreeListAllocator", isMappedRestored ? &mappedState : nullptr);
+	if (!isMappedRestored)
+	{
+		eosNew(Cat, &testMappedFreeListAllocator);
+		testMappedFreeListAllocator.GetState(mappedState);
+		mappedFileArea.SaveState(mappedState);
+		mappedFileArea.Flush();
+	}
+
 	///////////////////////////////////////////////////////////////////////
 
 	HeapArea<512> smartFreeListHeapArea;
@@ -176,7 +314,175 @@ int main()
 
 	///////////////////////////////////////////////////////////////////////
 
+	HeapArea<4096> tlsfHeapArea;
+	MemoryAllocator<TlsfAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testTlsfAllocator(tlsfHeapArea, "Test_TlsfAllocator");
+
+	Cat* tlsfCat0 = eosNew(Cat, &testTlsfAllocator);
+	Cat* tlsfCat1 = eosNew(Cat, &testTlsfAllocator);
+	eosDelete(tlsfCat0, &testTlsfAllocator);
+	Test* tlsfArray = eosNewArray(Test[16], &testTlsfAllocator);
+	eosDelete(tlsfCat1, &testTlsfAllocator);
+	eosDeleteArray(tlsfArray, &testTlsfAllocator);
+
+	// same allocator on huge pages, when the system allows it
+	HugePageAreaR hugePageHeapArea(4096);
+	MemoryAllocator<TlsfAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testHugePageTlsfAllocator(hugePageHeapArea, "Test_HugePageTlsfAllocator");
+	Test* hugePageArray = eosNewArray(Test[16], &testHugePageTlsfAllocator);
+	eosDeleteArray(hugePageArray, &testHugePageTlsfAllocator);
+
+	ThreadCachedAllocator<MemoryAllocator<TlsfAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>> testThreadCachedAllocator(&testTlsfAllocator);
+
+	Cat* cachedCat0 = eosNew(Cat, &testThreadCachedAllocator);
+	Cat* cachedCat1 = eosNew(Cat, &testThreadCachedAllocator);
+	eosDelete(cachedCat0, &testThreadCachedAllocator);
+	eosDelete(cachedCat1, &testThreadCachedAllocator);
+
+	NumaLocalAllocator<MemoryAllocator<TlsfAllocationPolicy, MultiThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>> testNumaLocalAllocator(4096, "Test_NumaLocalAllocator");
+
+	Cat* numaCat = eosNew(Cat, &testNumaLocalAllocator);
+	eosDelete(numaCat, &testNumaLocalAllocator);
+
+	///////////////////////////////////////////////////////////////////////
+
+	HeapArea<8192> buddyHeapArea;
+	MemoryAllocator<BuddyAllocationPolicy<64>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testBuddyAllocator(buddyHeapArea, "Test_BuddyAllocator");
+
+	Cat* buddyCat0 = eosNew(Cat, &testBuddyAllocator);
+	Test* buddyArray = eosNewArray(Test[64], &testBuddyAllocator);
+	eosDelete(buddyCat0, &testBuddyAllocator);
+	eosDeleteArray(buddyArray, &testBuddyAllocator);
+
+	// sized free, the block is found from the size and the alignment
+	Cat* buddyCat1 = eosNewAligned(Cat, &testBuddyAllocator, 32);
+	eosDeleteAligned(buddyCat1, &testBuddyAllocator, 32);
+
+
+	///////////////////////////////////////////////////////////////////////
+
+	HeapArea<2048> statsHeapArea;
+	MemoryAllocator<AllocationPolicy<TlsfAllocator, AllocationSizeHeader>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryStats<>> testStatsAllocator(statsHeapArea, "Test_StatsAllocator");
+
+	Cat* statsCat = eosNew(Cat, &testStatsAllocator);
+	Test* statsArray = eosNewArray(Test[8], &testStatsAllocator);
+
+	MemoryStatsSnapshot statsSnapshot;
+	testStatsAllocator.GetSnapshot(statsSnapshot);
+	std::string statsMetrics;
+	MemUtils::WriteOpenMetrics(&statsSnapshot, 1, statsMetrics);
+
+	eosDelete(statsCat, &testStatsAllocator);
+	eosDeleteArray(statsArray, &testStatsAllocator);
+
+	///////////////////////////////////////////////////////////////////////
+
+	{
+		HeapArea<2048> ringLogHeapArea;
+		MemoryAllocator<FreeListBestSearchAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, RingBufferMemoryLog<>> testRingLogAllocator(ringLogHeapArea, "Test_RingLogAllocator");
+
+		Cat* ringLogCat = eosNew(Cat, &testRingLogAllocator);
+		eosDelete(ringLogCat, &testRingLogAllocator);
+	}
+
+	// the file is complete only after the allocator is destroyed
+	uint64 ringLogDropped = 0;
+	MemUtils::ConvertRingBufferLog("Test_RingLogAllocator.eoslog", "Test_RingLogAllocator.csv", ringLogDropped);
+
+	///////////////////////////////////////////////////////////////////////
+
+	// every 64 bytes on average, so this small test has samples
+	HeapArea<2048> profiledHeapArea;
+	MemoryAllocator<FreeListBestSearchAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryHeapProfiler<MemoryLog, 64>> testProfiledAllocator(profiledHeapArea, "Test_ProfiledAllocator");
+
+	Cat* profiledCat = eosNew(Cat, &testProfiledAllocator);
+	Test* profiledArray = eosNewArray(Test[8], &testProfiledAllocator);
+	eosDelete(profiledCat, &testProfiledAllocator);
+
+	std::string heapProfile;
+	testProfiledAllocator.WriteHeapProfile(heapProfile);
+
+	eosDeleteArray(profiledArray, &testProfiledAllocator);
+
+	///////////////////////////////////////////////////////////////////////
+
+	{
+		HeapArea<2048> tracedHeapArea;
+		MemoryAllocator<FreeListFirstSearchAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryTraceLog<>> testTracedAllocator(tracedHeapArea, "Test_TracedAllocator");
+
+		Cat* tracedCat = eosNew(Cat, &testTracedAllocator);
+		Test* tracedArray = eosNewArray(Test[8], &testTracedAllocator);
+		eosDelete(tracedCat, &testTracedAllocator);
+		eosDeleteArray(tracedArray, &testTracedAllocator);
+	}
+
+	// the same trace replayed on the best fit
+	std::vector<MemoryTraceRecord> traceRecords;
+	MemUtils::ReadMemoryTrace("Test_TracedAllocator.eostrace", traceRecords);
+	eosAssert(traceRecords.empty() || traceRecords[0].m_size == sizeof(Cat), "The trace has the size of the block instead of the one asked");
+
+	HeapArea<2048> replayHeapArea;
+	MemoryAllocator<FreeListBestSearchAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testReplayAllocator(replayHeapArea, "Test_ReplayAllocator");
+
+	MemoryTraceReplayResult replayResult;
+	MemUtils::ReplayMemoryTrace(testReplayAllocator, traceRecords, traceRecords.size(), replayResult);
+
+	///////////////////////////////////////////////////////////////////////
+
+	using ScopeStackAllocator = MemoryAllocator<ScopeStackAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>;
+
+	HeapArea<1024> scopeStackHeapArea;
+	ScopeStackAllocator testScopeStackAllocator(scopeStackHeapArea, "Test_ScopeStackAllocator");
+	{
+		Scope<ScopeStackAllocator> outerScope(&testScopeStackAllocator);
+		eosNewScoped(Cat, &outerScope);
+		{
+			// everything created here is destroyed and released when the inner scope is closed
+			Scope<ScopeStackAllocator> innerScope(&testScopeStackAllocator);
+			eosNewScoped(Test, &innerScope);
+		}
+
+		// the cat and its finalizer, the rewind logged the others as freed
+		eosAssert(testScopeStackAllocator.GetNumAllocations() == 2, "The inner scope did not release its allocations");
+	}
+	eosAssert(testScopeStackAllocator.GetNumAllocations() == 0, "The outer scope did not release its allocations");
+
+	///////////////////////////////////////////////////////////////////////
+
+	HeapArea<1024> doubleEndedStackHeapArea;
+	using DoubleEndedStackAllocator = MemoryAllocator<DoubleEndedStackAllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>;
+	DoubleEndedStackAllocator testDoubleEndedStackAllocator(doubleEndedStackHeapArea, "Test_DoubleEndedStackAllocator");
+
+	// without the end it is the bottom one
+	Cat* persistentCat = eosNew(Cat, &testDoubleEndedStackAllocator);
+
+	StackEndAllocator<DoubleEndedStackAllocator> transientEnd(&testDoubleEndedStackAllocator, EStackEnd_Top);
+	const uintPtr transientMarker = transientEnd.GetMarker();
+	Test* transientArray = eosNewArray(Test[4], &transientEnd);
+	eosDeleteArray(transientArray, &transientEnd);
+	transientEnd.RewindTo(transientMarker);
+
+	eosDelete(persistentCat, &testDoubleEndedStackAllocator);
+
+	///////////////////////////////////////////////////////////////////////
+
+	HeapArea<1024> frameHeapArea;
+	MemoryAllocator<MultiBufferedFrameAllocationPolicy<3>, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog> testFrameAllocator(frameHeapArea, "Test_MultiBufferedFrameAllocator");
+
+	// the cat of this frame is still valid for the next 2 frames
+	Cat* frameCat = eosNew(Cat, &testFrameAllocator);
+	testFrameAllocator.AdvanceFrame();
+	Test* frameTest = eosNew(Test, &testFrameAllocator);
+	testFrameAllocator.AdvanceFrame();
+	eosDelete(frameCat, &testFrameAllocator);
+	eosDelete(frameTest, &testFrameAllocator);
+	testFrameAllocator.AdvanceFrame();
+
+	///////////////////////////////////////////////////////////////////////
+
 
 	Vector<Cat, FreeListAllocator, GetFreeListAllocator> catVector;
 	catVector.resize(16);
+
+	DefaultMap<int, Cat> catMap;
+	catMap[0] = Cat();
+	catMap[1] = Cat();
 }
\ No newline at end of file
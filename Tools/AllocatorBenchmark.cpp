@@ -0,0 +1,468 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Tools\AllocatorBenchmark.cpp
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+// Times the allocators with some allocation patterns and every combination of the bounds check, tag and log policies.
+// The result is JSON, one entry for each allocator, pattern and combination, to compare a release with the one before.
+// Usage: AllocatorBenchmark [rounds] [file.json]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Eos/Eos.h"
+
+
+EOS_USING_NAMESPACE
+
+
+namespace
+{
+	// the policies switched off, the bounds check and the tag of Eos are on only in debug,
+	// for the log the MemoryStats is used, which is on also in release
+	class NoBoundsCheck
+	{
+	public:
+		static constexpr size kSizeFront = 0;
+		static constexpr size kSizeBack = 0;
+
+		EOS_INLINE void GuardFront(void*) const {}
+		EOS_INLINE void GuardBack(void*) const {}
+
+		EOS_INLINE void CheckFront(const void*) const {}
+		EOS_INLINE void CheckBack(const void*) const {}
+	};
+
+	class NoTag
+	{
+	public:
+		EOS_INLINE void TagAllocation(void*, size) const {}
+		EOS_INLINE void TagDeallocation(void*, size) const {}
+	};
+
+	class NoLog
+	{
+	public:
+		NoLog(const char*) {}
+
+		EOS_INLINE void OnAllocation(void*, size, size, const LogSourceInfo&) const {}
+		EOS_INLINE void OnDeallocation(void*, size) const {}
+		EOS_INLINE void OnAllocationFailure(size, size, const LogSourceInfo&) const {}
+		EOS_INLINE size GetNumAllocations() const { return 0; }
+		EOS_INLINE size GetAllocatedSize() const { return 0; }
+		EOS_INLINE void Flush(size, size, size) {}
+		EOS_INLINE void Reset() {}
+	};
+
+
+	static constexpr size kAreaSize = 64 * 1024 * 1024;
+	static constexpr size kAlignment = 8;
+	static constexpr size kLiveCount = 1024;		// allocations alive at the same time
+	static constexpr size kRandomSteps = 4 * kLiveCount;
+	static constexpr size kReallocBuffers = 64;
+	static constexpr size kReallocMaxSize = 4096;
+	static constexpr size kPoolChunkSize = 256;
+
+	enum EPattern
+	{
+		EPattern_Lifo,			// allocates all, frees from the last
+		EPattern_Fifo,			// allocates all, frees from the first
+		EPattern_Random,		// frees and allocates again random slots, sizes from 16 to 256
+		EPattern_PowerLaw,		// as random, with many small sizes and a few big ones, up to 4096
+		EPattern_Realloc,		// buffers growing by half of their size, one after the other
+		EPattern_Count
+	};
+
+	static const char* kPatternNames[EPattern_Count] = { "lifo", "fifo", "random", "power_law", "realloc" };
+
+	// the operations of a round, taken before the timing so every allocator does the same ones
+	struct Round
+	{
+		std::vector<size> m_sizes;
+		std::vector<uint32> m_slots;
+	};
+
+	static Round MakeRound(EPattern _pattern, size _maxSize, std::mt19937& _random)
+	{
+		Round round;
+
+		std::uniform_int_distribution<size> uniformSize(16, 256 < _maxSize ? 256 : _maxSize);
+		std::uniform_int_distribution<uint32> slot(0, static_cast<uint32>(kLiveCount - 1));
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+		auto nextSize = [&]() -> size
+		{
+			if (_pattern != EPattern_PowerLaw)
+			{
+				return uniformSize(_random);
+			}
+
+			// Pareto with alpha 1.1 from 16 bytes
+			const double value = 16.0 / std::pow(1.0 - uniform(_random), 1.0 / 1.1);
+			const size maxSize = kReallocMaxSize < _maxSize ? kReallocMaxSize : _maxSize;
+			return value < static_cast<double>(maxSize) ? static_cast<size>(value) : maxSize;
+		};
+
+		switch (_pattern)
+		{
+		case EPattern_Lifo:
+		case EPattern_Fifo:
+			for (size i = 0; i < kLiveCount; ++i)
+			{
+				round.m_sizes.push_back(nextSize());
+			}
+			break;
+
+		case EPattern_Random:
+		case EPattern_PowerLaw:
+			for (size i = 0; i < kLiveCount + kRandomSteps; ++i)
+			{
+				round.m_sizes.push_back(nextSize());
+			}
+			for (size i = 0; i < kRandomSteps; ++i)
+			{
+				round.m_slots.push_back(slot(_random));
+			}
+			break;
+
+		case EPattern_Realloc:
+			for (size currentSize = 16; currentSize < kReallocMaxSize; currentSize += currentSize / 2)
+			{
+				round.m_sizes.push_back(currentSize);
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return round;
+	}
+
+
+	// the allocators of Eos, the ones which cannot free are reset at the end of each round
+	// and the ones with a fixed size (FixedSize not 0) get it for every allocation
+	template<class Allocator, bool ResetEachRound, size FixedSize>
+	class EosTarget
+	{
+	public:
+		EosTarget(const HeapAreaR& _area, const char* _name) : m_allocator(_area, _name) {}
+
+		EOS_INLINE void* Allocate(size _size) { return m_allocator.Allocate(FixedSize > 0 ? FixedSize : _size, kAlignment, EOS_ALLOCATION_INFO); }
+		EOS_INLINE void* Reallocate(void* _ptr, size _size) { return m_allocator.Reallocate(_ptr, _size, kAlignment, EOS_ALLOCATION_INFO); }
+		EOS_INLINE void Free(void* _ptr) { m_allocator.Free(_ptr); }
+
+		EOS_INLINE void EndRound()
+		{
+			if (ResetEachRound)
+			{
+				m_allocator.Reset();
+			}
+		}
+
+	private:
+		Allocator m_allocator;
+	};
+
+	class MallocTarget
+	{
+	public:
+		MallocTarget(const HeapAreaR&, const char*) {}
+
+		EOS_INLINE void* Allocate(size _size) { return malloc(_size); }
+		EOS_INLINE void* Reallocate(void* _ptr, size _size) { return realloc(_ptr, _size); }
+		EOS_INLINE void Free(void* _ptr) { free(_ptr); }
+		EOS_INLINE void EndRound() {}
+	};
+
+
+	struct Result
+	{
+		std::string m_allocator;
+		const char* m_pattern;
+		bool m_boundsCheck;
+		bool m_tag;
+		bool m_log;
+		uint64 m_operations;
+		uint64 m_failures;
+		double m_seconds;
+	};
+
+	// everything allocated in a round is freed in the same round
+	template<class Target>
+	static void RunRound(Target& _target, EPattern _pattern, const Round& _round, std::vector<void*>& _live, uint64& _operations, uint64& _failures, uintPtr& _sink)
+	{
+		switch (_pattern)
+		{
+		case EPattern_Lifo:
+		case EPattern_Fifo:
+		{
+			const size count = _round.m_sizes.size();
+			for (size i = 0; i < count; ++i)
+			{
+				_live[i] = _target.Allocate(_round.m_sizes[i]);
+			}
+			for (size i = 0; i < count; ++i)
+			{
+				void* ptr = _live[_pattern == EPattern_Lifo ? count - 1 - i : i];
+				_sink ^= (uintPtr)ptr;
+				if (ptr != nullptr)
+				{
+					_target.Free(ptr);
+				}
+				else
+				{
+					++_failures;
+				}
+			}
+			_operations += 2 * count;
+			break;
+		}
+
+		case EPattern_Random:
+		case EPattern_PowerLaw:
+		{
+			size next = 0;
+			for (size i = 0; i < kLiveCount; ++i)
+			{
+				_live[i] = _target.Allocate(_round.m_sizes[next++]);
+			}
+			for (uint32 slot : _round.m_slots)
+			{
+				if (_live[slot] != nullptr)
+				{
+					_target.Free(_live[slot]);
+				}
+				else
+				{
+					++_failures;
+				}
+				_live[slot] = _target.Allocate(_round.m_sizes[next++]);
+			}
+			for (size i = 0; i < kLiveCount; ++i)
+			{
+				_sink ^= (uintPtr)_live[i];
+				if (_live[i] != nullptr)
+				{
+					_target.Free(_live[i]);
+				}
+				else
+				{
+					++_failures;
+				}
+			}
+			_operations += 2 * (kLiveCount + _round.m_slots.size());
+			break;
+		}
+
+		case EPattern_Realloc:
+		{
+			for (size i = 0; i < kReallocBuffers; ++i)
+			{
+				_live[i] = _target.Allocate(_round.m_sizes[0]);
+			}
+			for (size step = 1; step < _round.m_sizes.size(); ++step)
+			{
+				for (size i = 0; i < kReallocBuffers; ++i)
+				{
+					if (_live[i] == nullptr)
+					{
+						continue;
+					}
+
+					void* ptr = _target.Reallocate(_live[i], _round.m_sizes[step]);
+					if (ptr == nullptr)
+					{
+						// the old buffer is still there
+						_target.Free(_live[i]);
+						++_failures;
+					}
+					_live[i] = ptr;
+				}
+			}
+			for (size i = 0; i < kReallocBuffers; ++i)
+			{
+				_sink ^= (uintPtr)_live[i];
+				if (_live[i] != nullptr)
+				{
+					_target.Free(_live[i]);
+				}
+			}
+			_operations += kReallocBuffers * (_round.m_sizes.size() + 1);
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		_target.EndRound();
+	}
+
+	template<class Target>
+	static void RunPattern(const char* _name, EPattern _pattern, size _maxSize, uint32 _rounds, bool _boundsCheck, bool _tag, bool _log, std::vector<Result>& _results)
+	{
+		HeapAreaR area(kAreaSize);
+		Target target(area, (std::string("Benchmark_") + _name + "_" + kPatternNames[_pattern]).c_str());
+
+		// the same rounds for every allocator
+		std::mt19937 random(1234);
+		std::vector<Round> rounds;
+		for (uint32 i = 0; i < _rounds; ++i)
+		{
+			rounds.push_back(MakeRound(_pattern, _maxSize, random));
+		}
+
+		std::vector<void*> live(kLiveCount, nullptr);
+		uint64 operations = 0;
+		uint64 failures = 0;
+		uintPtr sink = 0;
+
+		// a first round not timed, to touch the memory
+		RunRound(target, _pattern, rounds[0], live, operations, failures, sink);
+		operations = 0;
+		failures = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (const Round& round : rounds)
+		{
+			RunRound(target, _pattern, round, live, operations, failures, sink);
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		// the pointers are used, so the allocations are not removed by the compiler
+		volatile uintPtr usedPointers = sink;
+		(void)usedPointers;
+
+		Result result;
+		result.m_allocator = _name;
+		result.m_pattern = kPatternNames[_pattern];
+		result.m_boundsCheck = _boundsCheck;
+		result.m_tag = _tag;
+		result.m_log = _log;
+		result.m_operations = operations;
+		result.m_failures = failures;
+		result.m_seconds = std::chrono::duration<double>(end - start).count();
+		_results.push_back(result);
+	}
+
+	template<class AllocationPolicy, bool ResetEachRound, size FixedSize, class BoundsCheck, class Tag, class Log>
+	static void RunEosAllocator(const char* _name, size _maxSize, bool _realloc, uint32 _rounds, std::vector<Result>& _results)
+	{
+		using Allocator = MemoryAllocator<AllocationPolicy, SingleThreadPolicy, BoundsCheck, Tag, Log>;
+		using Target = EosTarget<Allocator, ResetEachRound, FixedSize>;
+
+		const bool boundsCheck = !std::is_same<BoundsCheck, NoBoundsCheck>::value;
+		const bool tag = !std::is_same<Tag, NoTag>::value;
+		const bool log = !std::is_same<Log, NoLog>::value;
+
+		for (uint32 pattern = 0; pattern < EPattern_Count; ++pattern)
+		{
+			if (pattern != EPattern_Realloc || _realloc)
+			{
+				RunPattern<Target>(_name, static_cast<EPattern>(pattern), _maxSize, _rounds, boundsCheck, tag, log, _results);
+			}
+		}
+	}
+
+	// every combination of the policies on and off, in release the bounds check and the tag do nothing so only the log is changed
+	template<class AllocationPolicy, bool ResetEachRound, size FixedSize>
+	static void RunEosAllocatorCombinations(const char* _name, size _maxSize, bool _realloc, uint32 _rounds, std::vector<Result>& _results)
+	{
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, NoBoundsCheck, NoTag, NoLog>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, NoBoundsCheck, NoTag, MemoryStats<NoLog>>(_name, _maxSize, _realloc, _rounds, _results);
+#if !defined(NDEBUG)
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, NoBoundsCheck, MemoryTag, NoLog>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, NoBoundsCheck, MemoryTag, MemoryStats<NoLog>>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, MemoryBoundsCheck, NoTag, NoLog>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, MemoryBoundsCheck, NoTag, MemoryStats<NoLog>>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, MemoryBoundsCheck, MemoryTag, NoLog>(_name, _maxSize, _realloc, _rounds, _results);
+		RunEosAllocator<AllocationPolicy, ResetEachRound, FixedSize, MemoryBoundsCheck, MemoryTag, MemoryStats<NoLog>>(_name, _maxSize, _realloc, _rounds, _results);
+#endif
+	}
+
+	static void WriteJson(const std::vector<Result>& _results, uint32 _rounds, std::string& _out)
+	{
+		std::ostringstream os;
+		os << "{\n";
+#if defined(NDEBUG)
+		os << "  \"build\": \"release\",\n";
+#else
+		os << "  \"build\": \"debug\",\n";
+#endif
+		os << "  \"rounds\": " << _rounds << ",\n";
+		os << "  \"results\": [\n";
+		for (size i = 0; i < _results.size(); ++i)
+		{
+			const Result& result = _results[i];
+			const double nsPerOperation = result.m_operations > 0 ? result.m_seconds * 1e9 / static_cast<double>(result.m_operations) : 0.0;
+			const double operationsPerSecond = result.m_seconds > 0.0 ? static_cast<double>(result.m_operations) / result.m_seconds : 0.0;
+
+			os << "    { \"allocator\": \"" << result.m_allocator << "\", \"pattern\": \"" << result.m_pattern << "\""
+				<< ", \"bounds_check\": " << (result.m_boundsCheck ? "true" : "false")
+				<< ", \"tag\": " << (result.m_tag ? "true" : "false")
+				<< ", \"log\": " << (result.m_log ? "true" : "false")
+				<< ", \"operations\": " << result.m_operations
+				<< ", \"failures\": " << result.m_failures
+				<< ", \"ns_per_op\": " << nsPerOperation
+				<< ", \"ops_per_second\": " << operationsPerSecond
+				<< " }" << (i + 1 < _results.size() ? "," : "") << "\n";
+		}
+		os << "  ]\n";
+		os << "}\n";
+
+		_out += os.str();
+	}
+}
+
+
+int main(int _argc, char* _argv[])
+{
+	const uint32 rounds = _argc > 1 ? static_cast<uint32>(atoi(_argv[1])) : 20;
+	if (rounds == 0 || _argc > 3)
+	{
+		fprintf(stderr, "Usage: %s [rounds] [file.json]\n", _argv[0]);
+		return 1;
+	}
+
+	std::vector<Result> results;
+
+	RunPattern<MallocTarget>("malloc", EPattern_Lifo, kReallocMaxSize, rounds, false, false, false, results);
+	RunPattern<MallocTarget>("malloc", EPattern_Fifo, kReallocMaxSize, rounds, false, false, false, results);
+	RunPattern<MallocTarget>("malloc", EPattern_Random, kReallocMaxSize, rounds, false, false, false, results);
+	RunPattern<MallocTarget>("malloc", EPattern_PowerLaw, kReallocMaxSize, rounds, false, false, false, results);
+	RunPattern<MallocTarget>("malloc", EPattern_Realloc, kReallocMaxSize, rounds, false, false, false, results);
+
+	// the linear allocator frees everything at the end of each round, the pool allocates always one chunk
+	RunEosAllocatorCombinations<LinearAllocationPolicy, true, 0>("linear", kReallocMaxSize, true, rounds, results);
+	RunEosAllocatorCombinations<PoolAllocationPolicy<kPoolChunkSize, kAlignment>, false, kPoolChunkSize>("pool", kPoolChunkSize, false, rounds, results);
+	RunEosAllocatorCombinations<FreeListFirstSearchAllocationPolicy, false, 0>("free_list_first", kReallocMaxSize, true, rounds, results);
+	RunEosAllocatorCombinations<FreeListBestSearchAllocationPolicy, false, 0>("free_list_best", kReallocMaxSize, true, rounds, results);
+	RunEosAllocatorCombinations<FreeListIndexedSearchAllocationPolicy, false, 0>("free_list_indexed", kReallocMaxSize, true, rounds, results);
+
+	std::string json;
+	WriteJson(results, rounds, json);
+
+	if (_argc < 3)
+	{
+		fputs(json.c_str(), stdout);
+		return 0;
+	}
+
+	FILE* file = nullptr;
+	if (fopen_s(&file, _argv[2], "w") != 0)
+	{
+		fprintf(stderr, "Cannot write %s\n", _argv[2]);
+		return 1;
+	}
+
+	fputs(json.c_str(), file);
+	fclose(file);
+	return 0;
+}
\ No newline at end of file
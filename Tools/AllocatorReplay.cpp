@@ -0,0 +1,207 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Tools\AllocatorReplay.cpp
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+// Replays a trace written by the MemoryTraceLog on some allocators, to choose one without running the program again.
+// For each allocator it gives the time, the peak of the used memory, the failed allocations
+// and, for the free lists, the fragmentation at the peak. The result is JSON.
+// Usage: AllocatorReplay trace.eostrace [area MB] [file.json]
+// Without the size of the area it is twice the peak of the trace, at least 1 MB.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Eos/Eos.h"
+
+
+EOS_USING_NAMESPACE
+
+
+namespace
+{
+	struct Result
+	{
+		const char* m_allocator;
+		MemoryTraceReplayResult m_replay;
+		bool m_hasFragmentation;
+		FreeListFragmentationReport m_fragmentation;
+	};
+
+	template<class AllocationPolicy>
+	using ReplayAllocator = MemoryAllocator<AllocationPolicy, SingleThreadPolicy, MemoryBoundsCheck, MemoryTag, MemoryLog>;
+
+	template<class Allocator>
+	static void GetFragmentationReport(Allocator& _allocator, FreeListFragmentationReport& _report, std::true_type)
+	{
+		_allocator.GetFragmentationReport(_report);
+	}
+
+	template<class Allocator>
+	static void GetFragmentationReport(Allocator&, FreeListFragmentationReport&, std::false_type)
+	{
+	}
+
+	// the free lists can walk their heap, the trace is replayed again on a new allocator up to the peak to take the fragmentation there
+	template<class AllocationPolicy, bool HasHeapWalk>
+	static void Replay(const char* _name, const std::vector<MemoryTraceRecord>& _records, size _areaSize, std::vector<Result>& _results)
+	{
+		Result result = {};
+		result.m_allocator = _name;
+
+		{
+			HeapAreaR area(_areaSize);
+			ReplayAllocator<AllocationPolicy> allocator(area, (std::string("Replay_") + _name).c_str());
+			MemUtils::ReplayMemoryTrace(allocator, _records, _records.size(), result.m_replay);
+		}
+
+		if (HasHeapWalk)
+		{
+			HeapAreaR area(_areaSize);
+			ReplayAllocator<AllocationPolicy> allocator(area, (std::string("Replay_") + _name + "_Peak").c_str());
+
+			MemoryTraceReplayResult peakReplay;
+			MemUtils::ReplayMemoryTrace(allocator, _records, result.m_replay.m_peakRecord, peakReplay);
+			GetFragmentationReport(allocator, result.m_fragmentation, std::integral_constant<bool, HasHeapWalk>());
+			result.m_hasFragmentation = true;
+		}
+
+		_results.push_back(result);
+	}
+
+	// the peak of the live sizes, with the records in order
+	static size GetTracePeak(const std::vector<MemoryTraceRecord>& _records)
+	{
+		std::vector<uint64> sizes;
+		uint64 live = 0;
+		uint64 peak = 0;
+		for (const MemoryTraceRecord& record : _records)
+		{
+			if (record.m_pointerId >= sizes.size())
+			{
+				sizes.resize(static_cast<size>(record.m_pointerId) + 1, 0);
+			}
+
+			switch (record.m_operation)
+			{
+			case EMemoryTraceOperation_Allocation:
+				sizes[record.m_pointerId] = record.m_pointerId != 0 ? record.m_size : 0;
+				live += sizes[record.m_pointerId];
+				break;
+
+			case EMemoryTraceOperation_Deallocation:
+				live -= sizes[record.m_pointerId];
+				sizes[record.m_pointerId] = 0;
+				break;
+
+			case EMemoryTraceOperation_Reset:
+				std::fill(sizes.begin(), sizes.end(), 0);
+				live = 0;
+				break;
+
+			default:
+				break;
+			}
+
+			peak = live > peak ? live : peak;
+		}
+		return static_cast<size>(peak);
+	}
+
+	static void WriteJson(const char* _traceFileName, size _recordCount, size _areaSize, const std::vector<Result>& _results, std::string& _out)
+	{
+		std::ostringstream os;
+		os << "{\n";
+		os << "  \"trace\": \"" << _traceFileName << "\",\n";
+		os << "  \"records\": " << _recordCount << ",\n";
+		os << "  \"area_size\": " << _areaSize << ",\n";
+		os << "  \"results\": [\n";
+		for (size i = 0; i < _results.size(); ++i)
+		{
+			const Result& result = _results[i];
+			const MemoryTraceReplayResult& replay = result.m_replay;
+			const double nsPerOperation = replay.m_operations > 0 ? replay.m_seconds * 1e9 / static_cast<double>(replay.m_operations) : 0.0;
+
+			os << "    { \"allocator\": \"" << result.m_allocator << "\""
+				<< ", \"operations\": " << replay.m_operations
+				<< ", \"seconds\": " << replay.m_seconds
+				<< ", \"ns_per_op\": " << nsPerOperation
+				<< ", \"failures\": " << replay.m_failures
+				<< ", \"recorded_failures\": " << replay.m_recordedFailures
+				<< ", \"peak_used\": " << replay.m_peakUsedMemory
+				<< ", \"peak_requested\": " << replay.m_peakRequestedMemory;
+			if (result.m_hasFragmentation)
+			{
+				os << ", \"external_fragmentation\": " << result.m_fragmentation.m_externalFragmentation
+					<< ", \"largest_free_block\": " << result.m_fragmentation.m_largestFreeBlock
+					<< ", \"free_blocks\": " << result.m_fragmentation.m_freeBlockCount
+					<< ", \"padding_waste\": " << result.m_fragmentation.m_paddingWaste;
+			}
+			else
+			{
+				os << ", \"external_fragmentation\": null, \"largest_free_block\": null, \"free_blocks\": null, \"padding_waste\": null";
+			}
+			os << " }" << (i + 1 < _results.size() ? "," : "") << "\n";
+		}
+		os << "  ]\n";
+		os << "}\n";
+
+		_out += os.str();
+	}
+}
+
+
+int main(int _argc, char* _argv[])
+{
+	if (_argc < 2 || _argc > 4)
+	{
+		fprintf(stderr, "Usage: %s trace.eostrace [area MB] [file.json]\n", _argv[0]);
+		return 1;
+	}
+
+	std::vector<MemoryTraceRecord> records;
+	if (!MemUtils::ReadMemoryTrace(_argv[1], records))
+	{
+		fprintf(stderr, "Cannot read the trace %s\n", _argv[1]);
+		return 1;
+	}
+
+	size areaSize = 2 * GetTracePeak(records);
+	if (_argc > 2)
+	{
+		areaSize = static_cast<size>(atoi(_argv[2])) * 1024 * 1024;
+	}
+	areaSize = areaSize > 1024 * 1024 ? areaSize : 1024 * 1024;
+
+	std::vector<Result> results;
+	Replay<FreeListFirstSearchAllocationPolicy, true>("free_list_first", records, areaSize, results);
+	Replay<FreeListBestSearchAllocationPolicy, true>("free_list_best", records, areaSize, results);
+	Replay<FreeListIndexedSearchAllocationPolicy, true>("free_list_indexed", records, areaSize, results);
+	Replay<TlsfAllocationPolicy, false>("tlsf", records, areaSize, results);
+	Replay<BuddyAllocationPolicy<64>, false>("buddy", records, areaSize, results);
+	Replay<SmallObjectAllocationPolicy<TlsfAllocator>, false>("small_object", records, areaSize, results);
+
+	std::string json;
+	WriteJson(_argv[1], records.size(), areaSize, results, json);
+
+	if (_argc < 4)
+	{
+		fputs(json.c_str(), stdout);
+		return 0;
+	}
+
+	FILE* file = nullptr;
+	if (fopen_s(&file, _argv[3], "w") != 0)
+	{
+		fprintf(stderr, "Cannot write %s\n", _argv[3]);
+		return 1;
+	}
+
+	fputs(json.c_str(), file);
+	fclose(file);
+	return 0;
+}
\ No newline at end of file
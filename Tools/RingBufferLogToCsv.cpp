@@ -0,0 +1,53 @@
+// Copyright (c) 2018-2025 Michele Condo'
+// File: C:\Projects\Eos\Tools\RingBufferLogToCsv.cpp
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+// Converts the binary file of the RingBufferMemoryLog in the CSV of the MemoryLog
+// Usage: RingBufferLogToCsv <file.eoslog> [file.csv]
+
+#include <cstdio>
+#include <string>
+
+#include "Eos/Eos.h"
+
+
+EOS_USING_NAMESPACE
+
+int main(int _argc, char* _argv[])
+{
+	if (_argc < 2 || _argc > 3)
+	{
+		fprintf(stderr, "Usage: %s <file.eoslog> [file.csv]\n", _argv[0]);
+		return 1;
+	}
+
+	std::string csvFileName;
+	if (_argc == 3)
+	{
+		csvFileName = _argv[2];
+	}
+	else
+	{
+		csvFileName = _argv[1];
+		const size_t extension = csvFileName.rfind(".eoslog");
+		if (extension != std::string::npos)
+		{
+			csvFileName.erase(extension);
+		}
+		csvFileName += ".csv";
+	}
+
+	uint64 droppedRecords = 0;
+	if (!MemUtils::ConvertRingBufferLog(_argv[1], csvFileName.c_str(), droppedRecords))
+	{
+		fprintf(stderr, "Cannot convert %s in %s\n", _argv[1], csvFileName.c_str());
+		return 1;
+	}
+
+	if (droppedRecords > 0)
+	{
+		fprintf(stderr, "%llu records were dropped, the rings were full\n", static_cast<unsigned long long>(droppedRecords));
+	}
+
+	return 0;
+}
\ No newline at end of file